@@ -17,8 +17,10 @@
 
 NativeHandle<EventHook> EventHandles;
 
-EventsMngr::ClEvent::ClEvent(CPluginMngr::CPlugin* plugin, const int func, const int flags)
+EventsMngr::ClEvent::ClEvent(EventsMngr* mngr, CPluginMngr::CPlugin* plugin, const int func, const int flags, const int msgid)
 {
+	m_Mngr = mngr;
+	m_MsgId = msgid;
 	m_Plugin = plugin;
 	m_Func = func;
 
@@ -51,22 +53,6 @@ EventsMngr::ClEvent::ClEvent(CPluginMngr::CPlugin* plugin, const int func, const
 	m_Stamp = 0.0f;
 	m_Done = false;
 	m_State = FSTATE_ACTIVE;
-	m_Conditions = nullptr;
-}
-
-EventsMngr::ClEvent::~ClEvent(void)
-{
-	cond_t *tmp1 = m_Conditions;
-	cond_t *tmp2 = nullptr;
-	
-	while (tmp1)
-	{
-		tmp2 = tmp1->next;
-		delete tmp1;
-		tmp1 = tmp2;
-	}
-	
-	m_Conditions = nullptr;
 }
 
 void EventsMngr::NextParam(void)
@@ -161,38 +147,49 @@ void EventsMngr::ClEvent::registerFilter(char *filter)
 	if (!*value)
 		return;
 
-	cond_t *tmpCond = new(std::nothrow) cond_t;
-	if (!tmpCond)
-		return;
-
 	// type character
-	tmpCond->type = *value;
+	const int type = *value;
 
 	// set a null here so param id can be recognized, and save it
 	*value++ = 0;
-	tmpCond->paramId = catoi(filter);
-
-	// rest of line
-	tmpCond->sValue = value;
-	tmpCond->fValue = catof(value);
-	tmpCond->iValue = catoi(value);
-	tmpCond->next = nullptr;
-
-	if (m_Conditions)
-	{
-		cond_t *tmp = m_Conditions;
-		while (tmp->next)
-			tmp = tmp->next;
-		
-		tmp->next = tmpCond;
-	}
-	else
-		m_Conditions = tmpCond;
+	m_Mngr->addFilter(this, catoi(filter), type, value);
 }
 
 void EventsMngr::ClEvent::setForwardState(const ForwardState state)
 {
 	m_State = state;
+	m_Mngr->updateListenMask(m_MsgId);
+}
+
+int EventsMngr::ClEvent::getListenFlags(void) const
+{
+	if (m_State != FSTATE_ACTIVE)
+		return 0;
+
+	int flags = 0;
+	if (m_FlagWorld)
+		flags |= LISTEN_WORLD;
+
+	if (m_FlagClient)
+	{
+		if (m_FlagPlayer)
+		{
+			if (m_FlagAlive)
+				flags |= LISTEN_PLAYER_ALIVE;
+			if (m_FlagDead)
+				flags |= LISTEN_PLAYER_DEAD;
+		}
+
+		if (m_FlagBot)
+		{
+			if (m_FlagAlive)
+				flags |= LISTEN_BOT_ALIVE;
+			if (m_FlagDead)
+				flags |= LISTEN_BOT_DEAD;
+		}
+	}
+
+	return flags;
 }
 
 int EventsMngr::registerEvent(CPluginMngr::CPlugin* plugin, const int func, const int flags, const int msgid)
@@ -200,7 +197,7 @@ int EventsMngr::registerEvent(CPluginMngr::CPlugin* plugin, const int func, cons
 	if (msgid < 0 || msgid >= MAX_AMX_REG_MSG)
 		return 0;
 
-	auto event = ke::AutoPtr<ClEvent>(new(std::nothrow) ClEvent(plugin, func, flags));
+	auto event = ke::AutoPtr<ClEvent>(new(std::nothrow) ClEvent(this, plugin, func, flags, msgid));
 	if (!event)
 		return 0;
 
@@ -209,18 +206,80 @@ int EventsMngr::registerEvent(CPluginMngr::CPlugin* plugin, const int func, cons
 		return 0;
 
 	m_Events[msgid].append(ke::Move(event));
+	updateListenMask(msgid);
 	return handle;
 }
 
-void EventsMngr::parserInit(const int msg_type, float* timer, CPlayer* pPlayer, const int index)
+void EventsMngr::updateListenMask(const int msgid)
 {
-	if (msg_type < 0 || msg_type > MAX_AMX_REG_MSG)
+	int flags = 0;
+	for (auto &event : m_Events[msgid])
+		flags |= event->getListenFlags();
+
+	m_ListenMask[msgid] = static_cast<uint8_t>(flags);
+}
+
+void EventsMngr::addFilter(ClEvent* event, const int paramId, const int type, const char* value)
+{
+	if (paramId < 0)
 		return;
 
+	ParamFilterTable &table = m_Filters[event->m_MsgId];
+	if (static_cast<size_t>(paramId) >= table.length() && !table.resize(paramId + 1))
+		return;
+
+	ParamFilter filter;
+	filter.event = event;
+	filter.type = type;
+	filter.sValue = value;
+	filter.sHash = cstrhash(value);
+	filter.fValue = catof(value);
+	filter.iValue = catoi(value);
+
+	// keep the conditions of an event next to each other, they are OR'ed together
+	ke::Vector<ParamFilter> &filters = table[paramId];
+	size_t i = filters.length();
+	while (i > 0 && filters[i - 1].event != event)
+		--i;
+
+	if (i == 0)
+		filters.append(ke::Move(filter));
+	else
+		filters.insert(i, ke::Move(filter));
+}
+
+ke::Vector<EventsMngr::ParamFilter>* EventsMngr::getParseFilters(void)
+{
+	if (!m_ParseFilters || static_cast<size_t>(m_ParsePos) >= m_ParseFilters->length())
+		return nullptr;
+
+	ke::Vector<ParamFilter> *filters = &m_ParseFilters->at(m_ParsePos);
+	if (filters->empty())
+		return nullptr;
+
+	return filters;
+}
+
+void EventsMngr::parserInit(const int msg_type, float* timer, CPlayer* pPlayer, const int index)
+{
 	m_ParseNotDone = false;
 
-	// don't parse if nothing to do
-	if (!m_Events[msg_type].length())
+	if (msg_type < 0 || msg_type >= MAX_AMX_REG_MSG)
+		return;
+
+	// don't parse if no active event can take this message
+	int listen;
+	if (pPlayer)
+	{
+		if (pPlayer->IsBot())
+			listen = pPlayer->IsAlive() ? LISTEN_BOT_ALIVE : LISTEN_BOT_DEAD;
+		else
+			listen = pPlayer->IsAlive() ? LISTEN_PLAYER_ALIVE : LISTEN_PLAYER_DEAD;
+	}
+	else
+		listen = LISTEN_WORLD;
+
+	if (!(m_ListenMask[msg_type] & listen))
 		return;
 
 	m_ParseMsgType = msg_type;
@@ -231,7 +290,7 @@ void EventsMngr::parserInit(const int msg_type, float* timer, CPlayer* pPlayer,
 		if (event->m_Done)
 			continue;
 
-		if (!event->m_Plugin->isExecutable(event->m_Func))
+		if (event->m_State != FSTATE_ACTIVE || !event->m_Plugin->isExecutable(event->m_Func))
 		{
 			event->m_Done = true;
 			continue;
@@ -269,6 +328,7 @@ void EventsMngr::parserInit(const int msg_type, float* timer, CPlayer* pPlayer,
 	}
 	
 	m_ParseFun = &m_Events[msg_type];
+	m_ParseFilters = &m_Filters[msg_type];
 }
 
 void EventsMngr::parseValue(const int iValue)
@@ -284,39 +344,37 @@ void EventsMngr::parseValue(const int iValue)
 	m_ParseVault[m_ParsePos].type = MSG_INTEGER;
 	m_ParseVault[m_ParsePos].iValue = iValue;
 
-	bool execute;
-	bool anyConditions;
+	// only the conditions on this param are looked at
+	ke::Vector<ParamFilter> *filters = getParseFilters();
+	if (!filters)
+		return;
 
-	// loop through the registered funcs, and decide whether they have to be called or not
-	// if they shouldnt, their m_Done is set to true
-	for (auto &event : *m_ParseFun)
+	// events with no matching condition on this param are set to m_Done
+	ClEvent *event;
+	bool execute;
+	size_t i = 0, count = filters->length();
+	while (i < count)
 	{
-		if (event->m_Done)
-			continue; // already skipped; don't bother with parsing
+		event = filters->at(i).event;
+		execute = event->m_Done; // already skipped; don't bother with parsing
 
-		// loop through conditions
-		execute = false;
-		anyConditions = false;
-		
-		for (auto condIter = event->m_Conditions; condIter; condIter = condIter->next)
+		for (; i < count && filters->at(i).event == event; ++i)
 		{
-			if (condIter->paramId == m_ParsePos)
+			if (execute)
+				continue;
+
+			const ParamFilter &filter = filters->at(i);
+			switch (filter.type)
 			{
-				anyConditions = true;
-				switch (condIter->type)
-				{
-					case '=': if (condIter->iValue == iValue) execute = true; break;
-					case '!': if (condIter->iValue != iValue) execute = true; break;
-					case '&': if (iValue & condIter->iValue) execute = true; break;
-					case '<': if (iValue < condIter->iValue) execute = true; break;
-					case '>': if (iValue > condIter->iValue) execute = true; break;
-				}
-				if (execute)
-					break;
+				case '=': if (filter.iValue == iValue) execute = true; break;
+				case '!': if (filter.iValue != iValue) execute = true; break;
+				case '&': if (iValue & filter.iValue) execute = true; break;
+				case '<': if (iValue < filter.iValue) execute = true; break;
+				case '>': if (iValue > filter.iValue) execute = true; break;
 			}
 		}
-		
-		if (anyConditions && !execute)
+
+		if (!execute)
 			event->m_Done = true; // don't execute
 	}
 }
@@ -334,39 +392,36 @@ void EventsMngr::parseValue(const float fValue)
 	m_ParseVault[m_ParsePos].type = MSG_FLOAT;
 	m_ParseVault[m_ParsePos].fValue = fValue;
 
-	bool execute;
-	bool anyConditions;
+	// only the conditions on this param are looked at
+	ke::Vector<ParamFilter> *filters = getParseFilters();
+	if (!filters)
+		return;
 
-	// loop through the registered funcs, and decide whether they have to be called or not
-	// if they shouldnt, their m_Done is set to true
-	for (auto &event : *m_ParseFun)
+	// events with no matching condition on this param are set to m_Done
+	ClEvent *event;
+	bool execute;
+	size_t i = 0, count = filters->length();
+	while (i < count)
 	{
-		if (event->m_Done)
-			continue; // already skipped; don't bother with parsing
+		event = filters->at(i).event;
+		execute = event->m_Done; // already skipped; don't bother with parsing
 
-		// loop through conditions
-		execute = false;
-		anyConditions = false;
-		
-		for (auto condIter = event->m_Conditions; condIter; condIter = condIter->next)
+		for (; i < count && filters->at(i).event == event; ++i)
 		{
-			if (condIter->paramId == m_ParsePos)
+			if (execute)
+				continue;
+
+			const ParamFilter &filter = filters->at(i);
+			switch (filter.type)
 			{
-				anyConditions = true;
-				switch (condIter->type)
-				{
-					case '=': if (condIter->fValue == fValue) execute = true; break;
-					case '!': if (condIter->fValue != fValue) execute = true; break;
-					case '<': if (fValue < condIter->fValue) execute = true; break;
-					case '>': if (fValue > condIter->fValue) execute = true; break;
-				}
-				
-				if (execute)
-					break;
+				case '=': if (filter.fValue == fValue) execute = true; break;
+				case '!': if (filter.fValue != fValue) execute = true; break;
+				case '<': if (fValue < filter.fValue) execute = true; break;
+				case '>': if (fValue > filter.fValue) execute = true; break;
 			}
 		}
-		
-		if (anyConditions && !execute)
+
+		if (!execute)
 			event->m_Done = true; // don't execute
 	}
 }
@@ -384,38 +439,37 @@ void EventsMngr::parseValue(const char *sz)
 	m_ParseVault[m_ParsePos].type = MSG_STRING;
 	m_ParseVault[m_ParsePos].sValue = sz;
 
-	bool execute;
-	bool anyConditions;
+	// only the conditions on this param are looked at
+	ke::Vector<ParamFilter> *filters = getParseFilters();
+	if (!filters)
+		return;
 
-	// loop through the registered funcs, and decide whether they have to be called or not
-	// if they shouldnt, their m_Done is set to true
-	for (auto &event : *m_ParseFun)
+	const uint32_t hash = cstrhash(sz);
+
+	// events with no matching condition on this param are set to m_Done
+	ClEvent *event;
+	bool execute;
+	size_t i = 0, count = filters->length();
+	while (i < count)
 	{
-		if (event->m_Done)
-			continue; // already skipped; don't bother with parsing
+		event = filters->at(i).event;
+		execute = event->m_Done; // already skipped; don't bother with parsing
 
-		// loop through conditions
-		execute = false;
-		anyConditions = false;
-		
-		for (auto condIter = event->m_Conditions; condIter; condIter = condIter->next)
+		for (; i < count && filters->at(i).event == event; ++i)
 		{
-			if (condIter->paramId == m_ParsePos)
+			if (execute)
+				continue;
+
+			const ParamFilter &filter = filters->at(i);
+			switch (filter.type)
 			{
-				anyConditions = true;
-				switch (condIter->type)
-				{
-					case '=': if (!cstrcmp(sz, condIter->sValue.chars())) execute = true; break;
-					case '!': if (cstrcmp(sz, condIter->sValue.chars())) execute = true; break;
-					case '&': if (strstr(sz, condIter->sValue.chars())) execute = true; break;
-				}
-				
-				if (execute)
-					break;
+				case '=': if (filter.sHash == hash && !cstrcmp(sz, filter.sValue.chars())) execute = true; break;
+				case '!': if (filter.sHash != hash || cstrcmp(sz, filter.sValue.chars())) execute = true; break;
+				case '&': if (strstr(sz, filter.sValue.chars())) execute = true; break;
 			}
 		}
-		
-		if (anyConditions && !execute)
+
+		if (!execute)
 			event->m_Done = true; // don't execute
 	}
 }
@@ -558,7 +612,14 @@ void EventsMngr::clearEvents(void)
 {
 	int i;
 	for (i = 0; i < MAX_AMX_REG_MSG; ++i)
+	{
 		m_Events[i].clear();
+		m_Filters[i].clear();
+		m_ListenMask[i] = 0;
+	}
+
+	m_ParseFun = nullptr;
+	m_ParseFilters = nullptr;
 
 	EventHandles.clear();
 
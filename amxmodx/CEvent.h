@@ -35,6 +35,16 @@ class EventsMngr
 		MSG_STRING,
 	};
 
+	// who a message can be parsed for, see m_ListenMask
+	enum ListenFlags
+	{
+		LISTEN_WORLD = (1<<0),
+		LISTEN_PLAYER_ALIVE = (1<<1),
+		LISTEN_PLAYER_DEAD = (1<<2),
+		LISTEN_BOT_ALIVE = (1<<3),
+		LISTEN_BOT_DEAD = (1<<4),
+	};
+
 	enum CS_EventsIds
 	{
 		CS_Null = 0, 
@@ -66,34 +76,36 @@ public:
 
 		bool m_Done;
 		ForwardState m_State;
-		
-		// conditions
-		struct cond_t
-		{
-			int paramId;				// the message parameter id
 
-			ke::AString sValue;				// value (string)
-			float fValue;				// value (float)
-			int iValue;					// value (int)
-			int type;					// type (can be int, float, string)
-
-			cond_t *next;
-		};
-
-		cond_t *m_Conditions;
+		EventsMngr *m_Mngr;						// owner of our compiled conditions
+		int m_MsgId;
 
 	public:
 		// constructors & destructors
-		ClEvent(CPluginMngr::CPlugin* plugin, int func, int flags);
-		~ClEvent();
+		ClEvent(EventsMngr* mngr, CPluginMngr::CPlugin* plugin, int func, int flags, int msgid);
 
 		inline CPluginMngr::CPlugin* getPlugin();
 		inline int getFunction();
 		void registerFilter(char* filter);			// add a condition
 		void setForwardState(ForwardState value);
+		int getListenFlags() const;
 	};
 
 private:
+	// a register_event condition, compiled into the list of the (message, param) it tests
+	struct ParamFilter
+	{
+		ClEvent *event;
+		int type;					// '=', '!', '&', '<' or '>'
+		int iValue;
+		float fValue;
+		ke::AString sValue;
+		uint32_t sHash;				// '=' and '!' on strings compare this first
+	};
+
+	// per message id, one filter list per param index; filters of the same event are adjacent
+	typedef ke::Vector<ke::Vector<ParamFilter>> ParamFilterTable;
+
 	struct MsgDataEntry
 	{
 		float fValue;
@@ -110,6 +122,9 @@ private:
 
 	ke::Vector<ke::AutoPtr<ClEvent>> m_Events[MAX_AMX_REG_MSG];
 	ke::Vector<ke::AutoPtr<ClEvent>> *m_ParseFun; // current Event vector
+	ParamFilterTable m_Filters[MAX_AMX_REG_MSG];
+	ParamFilterTable *m_ParseFilters;				// current filter table
+	uint8_t m_ListenMask[MAX_AMX_REG_MSG];			// ListenFlags of the active events of each message
 
 	bool m_ParseNotDone;
 	int m_ParsePos;				// is args. num. - 1
@@ -117,6 +132,9 @@ private:
 	float* m_Timer;
 	
 	ClEvent* getValidEvent(ClEvent* a);
+	void addFilter(ClEvent* event, int paramId, int type, const char* value);
+	void updateListenMask(int msgid);
+	ke::Vector<ParamFilter>* getParseFilters();
 
 	int m_ParseMsgType;
 	int m_ReadMsgType;
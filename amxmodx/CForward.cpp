@@ -18,6 +18,7 @@ CForward::CForward(const char *name, const ForwardExecType et, const int8_t numP
 	m_ExecType = et;
 	m_NumParams = numParams;
 	cmemcpy((void *)m_ParamTypes, paramTypes, numParams * sizeof(ForwardParam));
+	m_Plan.build(numParams, paramTypes);
 	
 	// find funcs
 	cell func;
@@ -38,20 +39,188 @@ CForward::CForward(const char *name, const ForwardExecType et, const int8_t numP
 }
 
 #define STRINGEX_MAXLENGTH 128
+
+void ForwardMarshalPlan::build(const int8_t numParams, const ForwardParam *paramTypes)
+{
+	m_NumMarshal = 0;
+	m_HasStrings = false;
+
+	int8_t i;
+	for (i = 0; i < numParams; ++i)
+	{
+		switch (paramTypes[i])
+		{
+			case FP_STRING:
+			case FP_STRINGEX:
+				m_HasStrings = true;
+				// fall through
+			case FP_ARRAY:
+			case FP_CELL_BYREF:
+			case FP_FLOAT_BYREF:
+				m_Marshal[m_NumMarshal++] = i;
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+// FP_STRING params are measured once per execute instead of once per plugin. FP_STRINGEX
+// ones are copied back after each plugin, which may change their length, they are
+// measured again when marshalled.
+static void ResolveForwardStrings(const ForwardMarshalPlan &plan, const ForwardParam *paramTypes, const cell *params, const char **strings, int *lengths)
+{
+	int8_t n, j;
+	for (n = 0; n < plan.m_NumMarshal; ++n)
+	{
+		j = plan.m_Marshal[n];
+		if (paramTypes[j] != FP_STRING && paramTypes[j] != FP_STRINGEX)
+			continue;
+
+		strings[j] = reinterpret_cast<const char*>(params[j]);
+		if (!strings[j])
+			strings[j] = "";
+
+		lengths[j] = (paramTypes[j] == FP_STRING) ? cstrlen(strings[j]) : -1;
+	}
+}
+
+static void MarshalForwardParams(AMX *amx, const ForwardMarshalPlan &plan, const ForwardParam *paramTypes, const cell *params, const char **strings, const int *lengths,
+								 ForwardPreparedArray *preparedArrays, cell *realParams, cell **physAddrs)
+{
+	unsigned int k, length;
+	const char* tmp2;
+	cell* tmp;
+	int8_t n, j;
+	for (n = 0; n < plan.m_NumMarshal; ++n)
+	{
+		j = plan.m_Marshal[n];
+		switch (paramTypes[j])
+		{
+			case FP_STRING:
+			case FP_STRINGEX:
+			{
+				amx_Allot(amx, (paramTypes[j] == FP_STRING) ? lengths[j] + 1 : STRINGEX_MAXLENGTH, &realParams[j], &tmp);
+				physAddrs[j] = tmp;
+
+				tmp2 = strings[j];
+				length = (paramTypes[j] == FP_STRING) ? lengths[j] : cstrlen(tmp2);
+				for (k = 0; k < length; ++k)
+					*tmp++ = static_cast<unsigned char>(*tmp2++);
+				*tmp = 0;
+				break;
+			}
+			case FP_ARRAY:
+			{
+				amx_Allot(amx, preparedArrays[params[j]].size, &realParams[j], &tmp);
+				physAddrs[j] = tmp;
+
+				if (preparedArrays[params[j]].type == Type_Cell)
+					cmemcpy(tmp, preparedArrays[params[j]].ptr, preparedArrays[params[j]].size * sizeof(cell));
+				else
+				{
+					tmp2 = (const char*)preparedArrays[params[j]].ptr;
+					for (k = 0; k < preparedArrays[params[j]].size; ++k)
+						*tmp++ = (static_cast<cell>(*tmp2++)) & 0xFF;
+				}
+				break;
+			}
+			case FP_CELL_BYREF:
+			case FP_FLOAT_BYREF:
+			{
+				amx_Allot(amx, 1, &realParams[j], &tmp);
+				physAddrs[j] = tmp;
+
+				if (paramTypes[j] == FP_CELL_BYREF)
+					cmemcpy(tmp, reinterpret_cast<cell*>(params[j]), sizeof(cell));
+				else
+					cmemcpy(tmp, reinterpret_cast<REAL*>(params[j]), sizeof(REAL));
+				break;
+			}
+			default:
+				break;
+		}
+	}
+}
+
+static void UnmarshalForwardParams(AMX *amx, const ForwardMarshalPlan &plan, const ForwardParam *paramTypes, const cell *params,
+								   ForwardPreparedArray *preparedArrays, const cell *realParams, cell **physAddrs)
+{
+	unsigned int k;
+	char* tmp2;
+	cell* tmp;
+	int8_t n, j;
+	for (n = 0; n < plan.m_NumMarshal; ++n)
+	{
+		j = plan.m_Marshal[n];
+		switch (paramTypes[j])
+		{
+			case FP_STRINGEX:
+			{
+				// copy back
+				amx_GetStringOld(reinterpret_cast<char*>(params[j]), physAddrs[j], 0);
+				break;
+			}
+			case FP_ARRAY:
+			{
+				// copy back
+				if (preparedArrays[params[j]].copyBack)
+				{
+					tmp = physAddrs[j];
+					if (preparedArrays[params[j]].type == Type_Cell)
+						cmemcpy(preparedArrays[params[j]].ptr, tmp, preparedArrays[params[j]].size * sizeof(cell));
+					else
+					{
+						tmp2 = (char*)preparedArrays[params[j]].ptr;
+						for (k = 0; k < preparedArrays[params[j]].size; ++k)
+							*tmp2++ = static_cast<char>(*tmp++ & 0xFF);
+					}
+				}
+				break;
+			}
+			case FP_CELL_BYREF:
+			case FP_FLOAT_BYREF:
+			{
+				// copy back
+				tmp = physAddrs[j];
+				if (paramTypes[j] == FP_CELL_BYREF)
+					cmemcpy(reinterpret_cast<cell *>(params[j]), tmp, sizeof(cell));
+				else
+					cmemcpy(reinterpret_cast<REAL *>(params[j]), tmp, sizeof(REAL));
+				break;
+			}
+			default:
+				break;
+		}
+
+		amx_Release(amx, realParams[j]);
+	}
+}
+
 cell CForward::execute(cell *params, ForwardPreparedArray *preparedArrays)
 {
 	cell realParams[FORWARD_MAX_PARAMS];
 	cell *physAddrs[FORWARD_MAX_PARAMS];
+	const char *strings[FORWARD_MAX_PARAMS];
+	int lengths[FORWARD_MAX_PARAMS];
 	cell globRetVal = 0;
 
+	// all-cell signatures push the caller's params as they are
+	const cell *pushParams = params;
+	if (m_Plan.m_NumMarshal)
+	{
+		cmemcpy(realParams, params, m_NumParams * sizeof(cell));
+		pushParams = realParams;
+
+		if (m_Plan.m_HasStrings)
+			ResolveForwardStrings(m_Plan, m_ParamTypes, params, strings, lengths);
+	}
+
 	// loop cache
 	cell retVal;
 	int err;
-	unsigned int k;
-	char* tmp2;
 	AMX* amx;
 	Debugger* pDebugger;
-	cell* tmp;
 	int8_t j;
 	size_t i;
 	for (i = 0; i < m_Funcs.length(); ++i)
@@ -66,49 +235,12 @@ cell CForward::execute(cell *params, ForwardPreparedArray *preparedArrays)
 				pDebugger->BeginExec();
 			
 			// handle strings & arrays & values by reference
-			for (j = 0; j < m_NumParams; ++j)
-			{
-				if (m_ParamTypes[j] == FP_STRING || m_ParamTypes[j] == FP_STRINGEX)
-				{
-					tmp2 = reinterpret_cast<char*>(params[j]);
-					if (!tmp2)
-						tmp2 = "";
-
-					amx_Allot(amx, (m_ParamTypes[j] == FP_STRING) ? cstrlen(tmp2) + 1 : STRINGEX_MAXLENGTH, &realParams[j], &tmp);
-					amx_SetStringOld(tmp, tmp2, 0, 0);
-					physAddrs[j] = tmp;
-				}
-				else if (m_ParamTypes[j] == FP_ARRAY)
-				{
-					amx_Allot(amx, preparedArrays[params[j]].size, &realParams[j], &tmp);
-					physAddrs[j] = tmp;
-					
-					if (preparedArrays[params[j]].type == Type_Cell)
-						cmemcpy(tmp, preparedArrays[params[j]].ptr, preparedArrays[params[j]].size * sizeof(cell));
-					else
-					{
-						tmp2 = (char*)preparedArrays[params[j]].ptr;
-						for (k = 0; k < preparedArrays[params[j]].size; ++k)
-							*tmp++ = (static_cast<cell>(*tmp2++)) & 0xFF;
-					}
-				}
-				else if (m_ParamTypes[j] == FP_CELL_BYREF || m_ParamTypes[j] == FP_FLOAT_BYREF)
-				{
-					amx_Allot(amx, 1, &realParams[j], &tmp);
-					physAddrs[j] = tmp;
-
-					if (m_ParamTypes[j] == FP_CELL_BYREF)
-						cmemcpy(tmp, reinterpret_cast<cell*>(params[j]), sizeof(cell));
-					else
-						cmemcpy(tmp, reinterpret_cast<REAL*>(params[j]), sizeof(REAL));
-				}
-				else
-					realParams[j] = params[j];
-			}
+			if (m_Plan.m_NumMarshal)
+				MarshalForwardParams(amx, m_Plan, m_ParamTypes, params, strings, lengths, preparedArrays, realParams, physAddrs);
 			
 			// push the parameters in reverse order. Weird, unfriendly part of Small 3.0!
 			for (j = m_NumParams-1; j >= 0; j--)
-				amx_Push(amx, realParams[j]);
+				amx_Push(amx, pushParams[j]);
 			
 			// exec
 			retVal = 0;
@@ -116,7 +248,11 @@ cell CForward::execute(cell *params, ForwardPreparedArray *preparedArrays)
 			g_BinLog.WriteOp(BinLog_CallPubFunc, iter->pPlugin->getId(), iter->func);
 #endif
 
-			err = amx_ExecPerf(amx, &retVal, iter->func);
+			if (g_profiler.IsActive())
+				err = g_profiler.ExecPublic(iter->pPlugin, amx, &retVal, iter->func);
+			else
+				err = amx_ExecPerf(amx, &retVal, iter->func);
+
 			// log runtime error, if any
 			if (err != AMX_ERR_NONE)
 			{
@@ -137,46 +273,8 @@ cell CForward::execute(cell *params, ForwardPreparedArray *preparedArrays)
 				pDebugger->EndExec();
 
 			// cleanup strings & arrays & values by reference
-			for (j = 0; j < m_NumParams; ++j)
-			{
-				if (m_ParamTypes[j] == FP_STRING)
-					amx_Release(amx, realParams[j]);
-				else if (m_ParamTypes[j] == FP_STRINGEX)
-				{
-					// copy back
-					amx_GetStringOld(reinterpret_cast<char*>(params[j]), physAddrs[j], 0);
-					amx_Release(amx, realParams[j]);
-				}
-				else if (m_ParamTypes[j] == FP_ARRAY)
-				{
-					// copy back
-					if (preparedArrays[params[j]].copyBack)
-					{
-						tmp = physAddrs[j];
-						if (preparedArrays[params[j]].type == Type_Cell)
-							cmemcpy(preparedArrays[params[j]].ptr, tmp, preparedArrays[params[j]].size * sizeof(cell));
-						else
-						{
-							tmp2 = (char*)preparedArrays[params[j]].ptr;
-							for (k = 0; k < preparedArrays[params[j]].size; ++k)
-								*tmp2++ = static_cast<char>(*tmp++ & 0xFF);
-						}
-					}
-
-					amx_Release(amx, realParams[j]);
-				}
-				else if (m_ParamTypes[j] == FP_CELL_BYREF || m_ParamTypes[j] == FP_FLOAT_BYREF)
-				{
-					// copy back
-					tmp = physAddrs[j];
-					if (m_ParamTypes[j] == FP_CELL_BYREF)
-						cmemcpy(reinterpret_cast<cell *>(params[j]), tmp, sizeof(cell));
-					else
-						cmemcpy(reinterpret_cast<REAL *>(params[j]), tmp, sizeof(REAL));
-
-					amx_Release(amx, realParams[j]);
-				}
-			}
+			if (m_Plan.m_NumMarshal)
+				UnmarshalForwardParams(amx, m_Plan, m_ParamTypes, params, preparedArrays, realParams, physAddrs);
 
 			// decide what to do (based on exectype and retval)
 			switch (m_ExecType)
@@ -216,6 +314,7 @@ void CSPForward::Set(const cell func, AMX *amx, const int8_t numParams, const Fo
 	m_Amx = amx;
 	m_NumParams = numParams;
 	cmemcpy((void *)m_ParamTypes, paramTypes, numParams * sizeof(ForwardParam));
+	m_Plan.build(numParams, paramTypes);
 	m_HasFunc = true;
 	isFree = false;
 	name[0] = '\0';
@@ -230,6 +329,7 @@ void CSPForward::Set(const char *funcName, AMX *amx, const int8_t numParams, con
 	m_Amx = amx;
 	m_NumParams = numParams;
 	cmemcpy((void *)m_ParamTypes, paramTypes, numParams * sizeof(ForwardParam));
+	m_Plan.build(numParams, paramTypes);
 	m_HasFunc = (amx_FindPublic(amx, funcName, &m_Func) == AMX_ERR_NONE);
 	isFree = false;
 	m_Name = funcName;
@@ -261,57 +361,33 @@ cell CSPForward::execute(cell *params, ForwardPreparedArray *preparedArrays)
 	// handle strings & arrays & values by reference
 	cell retVal;
 	int err;
-	unsigned int k;
-	char* tmp2;
-	cell* tmp;
 	int8_t i;
-	for (i = 0; i < m_NumParams; ++i)
+	const char *strings[FORWARD_MAX_PARAMS];
+	int lengths[FORWARD_MAX_PARAMS];
+	const cell *pushParams = params;
+	if (m_Plan.m_NumMarshal)
 	{
-		if (m_ParamTypes[i] == FP_STRING || m_ParamTypes[i] == FP_STRINGEX)
-		{
-			tmp2 = reinterpret_cast<char*>(params[i]);
-			if (!tmp2)
-				tmp2 = "";
-			amx_Allot(m_Amx, (m_ParamTypes[i] == FP_STRING) ? cstrlen(tmp2) + 1 : STRINGEX_MAXLENGTH, &realParams[i], &tmp);
-			amx_SetStringOld(tmp, tmp2, 0, 0);
-			physAddrs[i] = tmp;
-		}
-		else if (m_ParamTypes[i] == FP_ARRAY)
-		{
-			amx_Allot(m_Amx, preparedArrays[params[i]].size, &realParams[i], &tmp);
-			physAddrs[i] = tmp;
-			
-			if (preparedArrays[params[i]].type == Type_Cell)
-				cmemcpy(tmp, preparedArrays[params[i]].ptr, preparedArrays[params[i]].size * sizeof(cell));
-			else
-			{
-				tmp2 = (char*)preparedArrays[params[i]].ptr;
-				for (k = 0; k < preparedArrays[params[i]].size; ++k)
-					*tmp++ = (static_cast<cell>(*tmp2++)) & 0xFF;
-			}
-		}
-		else if (m_ParamTypes[i] == FP_CELL_BYREF || m_ParamTypes[i] == FP_FLOAT_BYREF)
-		{
-			amx_Allot(m_Amx, 1, &realParams[i], &tmp);
-			physAddrs[i] = tmp;
-			if (m_ParamTypes[i] == FP_CELL_BYREF)
-				cmemcpy(tmp, reinterpret_cast<cell*>(params[i]), sizeof(cell));
-			else
-				cmemcpy(tmp, reinterpret_cast<REAL*>(params[i]), sizeof(REAL));
-		}
-		else
-			realParams[i] = params[i];
+		cmemcpy(realParams, params, m_NumParams * sizeof(cell));
+		pushParams = realParams;
+
+		if (m_Plan.m_HasStrings)
+			ResolveForwardStrings(m_Plan, m_ParamTypes, params, strings, lengths);
+
+		MarshalForwardParams(m_Amx, m_Plan, m_ParamTypes, params, strings, lengths, preparedArrays, realParams, physAddrs);
 	}
 	
 	for (i = m_NumParams - 1; i >= 0; i--)
-		amx_Push(m_Amx, realParams[i]);
+		amx_Push(m_Amx, pushParams[i]);
 	
 	// exec
 	retVal = 0;
 #if defined BINLOG_ENABLED
 	g_BinLog.WriteOp(BinLog_CallPubFunc, pPlugin->getId(), m_Func);
 #endif
-	err = amx_ExecPerf(m_Amx, &retVal, m_Func);
+	if (g_profiler.IsActive())
+		err = g_profiler.ExecPublic(pPlugin, m_Amx, &retVal, m_Func);
+	else
+		err = amx_ExecPerf(m_Amx, &retVal, m_Func);
 	if (err != AMX_ERR_NONE)
 	{
 		// did something else set an error?
@@ -332,44 +408,8 @@ cell CSPForward::execute(cell *params, ForwardPreparedArray *preparedArrays)
 	m_Amx->error = AMX_ERR_NONE;
 
 	// cleanup strings & arrays & values by reference
-	for (i = 0; i < m_NumParams; ++i)
-	{
-		if (m_ParamTypes[i] == FP_STRING)
-			amx_Release(m_Amx, realParams[i]);
-		else if (m_ParamTypes[i] == FP_STRINGEX)
-		{
-			// copy back
-			amx_GetStringOld(reinterpret_cast<char*>(params[i]), physAddrs[i], 0);
-			amx_Release(m_Amx, realParams[i]);
-		}
-		else if (m_ParamTypes[i] == FP_ARRAY)
-		{
-			// copy back
-			if (preparedArrays[params[i]].copyBack)
-			{
-				tmp = physAddrs[i];
-				if (preparedArrays[params[i]].type == Type_Cell)
-					cmemcpy(preparedArrays[params[i]].ptr, tmp, preparedArrays[params[i]].size * sizeof(cell));
-				else
-				{
-					tmp2 = (char*)preparedArrays[params[i]].ptr;
-					for (k = 0; k < preparedArrays[params[i]].size; ++k)
-						*tmp2++ = static_cast<char>(*tmp++ & 0xFF);
-				}
-			}
-			amx_Release(m_Amx, realParams[i]);
-		}
-		else if (m_ParamTypes[i] == FP_CELL_BYREF || m_ParamTypes[i] == FP_FLOAT_BYREF)
-		{
-			// copy back
-			tmp = physAddrs[i];
-			if (m_ParamTypes[i] == FP_CELL_BYREF)
-				cmemcpy(reinterpret_cast<cell *>(params[i]), tmp, sizeof(cell));
-			else
-				cmemcpy(reinterpret_cast<REAL *>(params[i]), tmp, sizeof(REAL));
-			amx_Release(m_Amx, realParams[i]);
-		}
-	}
+	if (m_Plan.m_NumMarshal)
+		UnmarshalForwardParams(m_Amx, m_Plan, m_ParamTypes, params, preparedArrays, realParams, physAddrs);
 
 	m_InExec = false;
 	return retVal;
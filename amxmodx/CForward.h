@@ -65,6 +65,17 @@ struct ForwardPreparedArray
 	bool copyBack;
 };
 
+// Parameter handling worked out at registration time, so execute only visits
+// the parameters that need space on the plugin's heap
+struct ForwardMarshalPlan
+{
+	int8_t m_NumMarshal;						// strings, arrays and references
+	int8_t m_Marshal[FORWARD_MAX_PARAMS];		// their indexes, in order
+	bool m_HasStrings;
+
+	void build(const int8_t numParams, const ForwardParam *paramTypes);
+};
+
 // Normal forward
 class CForward
 {
@@ -83,6 +94,7 @@ class CForward
 	
 	AMXForwardList m_Funcs;
 	ForwardParam m_ParamTypes[FORWARD_MAX_PARAMS];
+	ForwardMarshalPlan m_Plan;
 
 public:
 	CForward(const char *name, const ForwardExecType et, const int8_t numParams, const ForwardParam * paramTypes);
@@ -106,6 +118,7 @@ class CSPForward
 	friend class CForwardMngr;
 	int8_t m_NumParams;
 	ForwardParam m_ParamTypes[FORWARD_MAX_PARAMS];
+	ForwardMarshalPlan m_Plan;
 	AMX *m_Amx;
 	cell m_Func;
 	bool m_HasFunc;
@@ -79,19 +79,6 @@ int HashAlt<ke::AString>(ke::AString const &k)
 	return hash;
 }
 
-
-template<>
-int HashFunction<int>(const int &k)
-{
-	return k;
-}
-
-template<>
-int Compare<int>(const int &k1, const int &k2)
-{
-	return (k1 - k2);
-}
-
 // strip the whitespaces at the beginning and the end of a string
 // also convert to lowercase if needed
 // return the number of written characters (including the terimating zero char)
@@ -138,13 +125,11 @@ size_t CLangMngr::strip(char *str, char *newstr, bool makelower)
 
 CLangMngr::CLang::CLang()
 {
-	m_LookUpTable.clear();
 	m_entries = 0;
 }
 
 CLangMngr::CLang::CLang(const char *lang)
 {
-	m_LookUpTable.clear();
 	m_entries = 0;
 	strncpy(m_LanguageName, lang, 2);
 	m_LanguageName[2] = 0;
@@ -152,16 +137,30 @@ CLangMngr::CLang::CLang(const char *lang)
 
 void CLangMngr::CLang::AddEntry(int key, const char *definition)
 {
-	defentry &d = m_LookUpTable[key];
+	// keys not made by the manager can't be looked up anyway
+	if (key < 0 || key >= static_cast<int>(m_LMan->KeyList.length()))
+		return;
 
-	if (d.definition)
+	size_t length = m_LookUpTable.length();
+	if (static_cast<size_t>(key) >= length)
 	{
-		delete d.definition;
+		if (!m_LookUpTable.resize(key + 1))
+			return;
+
+		for (; length < m_LookUpTable.length(); length++)
+			m_LookUpTable[length] = NULL;
+	}
+
+	ke::AString *&d = m_LookUpTable[key];
+
+	if (d)
+	{
+		delete d;
 	} else {
 		m_entries++;
 	}
 
-	d.definition = new ke::AString(definition);
+	d = new ke::AString(definition);
 }
 
 CLangMngr::CLang::~CLang()
@@ -171,14 +170,10 @@ CLangMngr::CLang::~CLang()
 
 void CLangMngr::CLang::Clear()
 {
-	THash<int, defentry>::iterator iter;
-	for (iter=m_LookUpTable.begin(); iter!=m_LookUpTable.end(); iter++)
+	for (size_t i = 0; i < m_LookUpTable.length(); i++)
 	{
-		if (iter->val.definition)
-		{
-			delete iter->val.definition;
-			iter->val.definition = NULL;
-		}
+		if (m_LookUpTable[i])
+			delete m_LookUpTable[i];
 	}
 	m_LookUpTable.clear();
 	m_entries = 0;
@@ -204,16 +199,14 @@ void CLangMngr::CLang::MergeDefinitions(ke::Vector<sKeyDef> &vec)
 
 const char * CLangMngr::CLang::GetDef(int key, int &status)
 {
-	defentry &def = m_LookUpTable[key];
-
-	if (!def.definition)
+	if (key < 0 || key >= static_cast<int>(m_LookUpTable.length()) || !m_LookUpTable[key])
 	{
 		status = ERR_BADKEY;
 		return NULL;
 	}
 
 	status = 0;
-	return def.definition->chars();
+	return m_LookUpTable[key]->chars();
 }
 
 int CLangMngr::CLang::Entries()
@@ -223,7 +216,7 @@ int CLangMngr::CLang::Entries()
 
 /******** CLangMngr *********/
 
-CLangMngr::CLangMngr()
+CLangMngr::CLangMngr() : m_LangsVersion(0)
 {
 	Clear();
 }
@@ -238,21 +231,21 @@ const char * CLangMngr::GetKey(int key)
 
 int CLangMngr::GetKeyEntry(const char *key)
 {
-	keytbl_val &val = KeyTable[ke::AString(key)];
+	int index;
+	if (!KeyTable.retrieve(key, &index))
+		return -1;
 
-	return val.index;
+	return index;
 }
 
 int CLangMngr::AddKeyEntry(const char *key)
 {
-	keytbl_val val;
-	val.index = static_cast<int>(KeyList.length());
+	const int index = static_cast<int>(KeyList.length());
 
 	KeyList.append(new ke::AString(key));
+	KeyTable.replace(key, index);
 
-	KeyTable[ke::AString(key)] = val;
-
-	return val.index;
+	return index;
 }
 
 int CLangMngr::AddKeyEntry(ke::AString &key)
@@ -262,9 +255,7 @@ int CLangMngr::AddKeyEntry(ke::AString &key)
 
 int CLangMngr::GetKeyEntry(ke::AString &key)
 {
-	keytbl_val &val = KeyTable[key];
-
-	return val.index;
+	return GetKeyEntry(key.chars());
 }
 
 char * CLangMngr::FormatAmxString(AMX *amx, cell *params, int parm, int &len)
@@ -503,56 +494,58 @@ int CLangMngr::MergeDefinitionFile(const char *file)
 // Find a CLang by name, if not found, add it
 CLangMngr::CLang * CLangMngr::GetLang(const char *name)
 {
-	size_t iter;
-	const size_t length = m_Languages.length();
-	for (iter = 0; iter < length; ++iter)
-	{
-		if (cstrcmp(m_Languages[iter]->GetName(), name) == 0)
-			return m_Languages[iter];
-	}
+	// languages are known by their first two characters only
+	char buf[3];
+	strncopy(buf, name, sizeof(buf));
+
+	CLang *p = GetLangR(buf);
+	if (p)
+		return p;
 
-	CLang *p = new(std::nothrow) CLang(name);
+	p = new(std::nothrow) CLang(buf);
 	if (!p)
 		return nullptr;
 
 	p->SetMngr(this);
+	LangTable.insert(p->GetName(), static_cast<int>(m_Languages.length()));
 	m_Languages.append(p);
+	m_LangsVersion++;
 	return p;
 }
 
 // Find a CLang by name, if not found, return NULL
 CLangMngr::CLang * CLangMngr::GetLangR(const char *name)
 {
-	size_t iter;
-	const size_t length = m_Languages.length();
-	for (iter = 0; iter < length; ++iter)
-	{
-		if (cstrcmp(m_Languages[iter]->GetName(), name) == 0)
-			return m_Languages[iter];
-	}
+	const int langId = GetLangId(name);
+	if (langId == -1)
+		return nullptr;
 
-	return nullptr;
+	return m_Languages[langId];
 }
 
-const char *CLangMngr::GetDef(const char *langName, const char *key, int &status)
+int CLangMngr::GetLangId(const char *langName)
 {
-	CLang *lang = GetLangR(langName);
-	keytbl_val &val = KeyTable.AltFindOrInsert(ke::AString(key)); //KeyTable[make_string(key)];
-	if (!lang)
+	int langId;
+	if (!LangTable.retrieve(langName, &langId))
+		return -1;
+
+	return langId;
+}
+
+const char *CLangMngr::GetDef(int langId, int key, int &status)
+{
+	if (langId < 0 || langId >= static_cast<int>(m_Languages.length()))
 	{
 		status = ERR_BADLANG;
 		return nullptr;
 	}
-	else if (val.index == -1)
-	{
-		status = ERR_BADKEY;
-		return nullptr;
-	}
-	else
-	{
-		status = 0;
-		return lang->GetDef(val.index, status);
-	}
+
+	return m_Languages[langId]->GetDef(key, status);
+}
+
+const char *CLangMngr::GetDef(const char *langName, const char *key, int &status)
+{
+	return GetDef(GetLangId(langName), GetKeyEntry(key), status);
 }
 
 void CLangMngr::InvalidateCache(void)
@@ -571,6 +564,9 @@ void CLangMngr::Clear(void)
 	size_t length = m_Languages.length();
 
 	KeyTable.clear();
+	LangTable.clear();
+	m_LangsVersion++;
+
 	for (i = 0; i < length; i++)
 	{
 		if (m_Languages[i])
@@ -596,15 +592,10 @@ int CLangMngr::GetLangsNum(void)
 
 const char *CLangMngr::GetLangName(const size_t langId)
 {
-	size_t iter;
-	const size_t length = m_Languages.length();
-	for (iter = 0; iter < length; ++iter)
-	{
-		if (iter == langId)
-			return m_Languages[iter]->GetName();
-	}
+	if (langId >= m_Languages.length())
+		return "";
 
-	return "";
+	return m_Languages[langId]->GetName();
 }
 
 bool CLangMngr::LangExists(const char *langName)
@@ -618,15 +609,7 @@ bool CLangMngr::LangExists(const char *langName)
 			break;
 	}
 	
-	size_t iter;
-	const size_t length = m_Languages.length();
-	for (iter = 0; iter < length; ++iter)
-	{
-		if (cstrcmp(m_Languages[iter]->GetName(), buf) == 0)
-			return true;
-	}
-
-	return false;
+	return GetLangId(buf) != -1;
 }
 
 void CLangMngr::SetDefLang(const int id)
@@ -34,30 +34,6 @@ struct lang_err
 	float last;
 };
 
-class defentry
-{
-public:
-	defentry() : definition(NULL)
-	{
-	};
-	defentry(const defentry &src)
-	{
-		definition = src.definition;
-	}
-	~defentry()
-	{
-	}
-	ke::AString *definition;
-};
-
-struct keytbl_val
-{
-	keytbl_val() : index(-1)
-	{
-	};
-	int index;
-};
-
 class CLangMngr : public ITextListener_INI
 {
 	class CLang
@@ -89,13 +65,10 @@ class CLangMngr : public ITextListener_INI
 		// Get number of entries
 		int Entries();
 	protected:
-		typedef THash<int, defentry> LookUpVec;
-		typedef LookUpVec::iterator	 LookUpVecIter;
-
 		char m_LanguageName[3];
 
-		// our lookup table
-		LookUpVec m_LookUpTable;
+		// definitions indexed by key id, NULL when not translated
+		ke::Vector<ke::AString *> m_LookUpTable;
 		int m_entries;
 		CLangMngr *m_LMan;
 	public:
@@ -121,7 +94,11 @@ private:
 
 	StringHashMap<time_t> FileList;
 	ke::Vector<ke::AString *> KeyList;
-	THash<ke::AString, keytbl_val> KeyTable;
+	StringHashMap<int> KeyTable;
+	StringHashMap<int> LangTable;	// name -> index in m_Languages
+
+	// Bumped whenever language ids may change, see GetLangsVersion
+	int m_LangsVersion;
 
 	// Get a lang object (construct if needed)
 	CLang * GetLang(const char *name);
@@ -135,6 +112,8 @@ public:
 	int MergeDefinitionFile(const char *file);
 	// Get a definition from a lang name and a key
 	const char *GetDef(const char *langName, const char *key, int &status);
+	// Get a definition from ids, doesn't touch any string
+	const char *GetDef(int langId, int key, int &status);
 	// Format a string for an AMX plugin
 	char *FormatAmxString(AMX *amx, cell *params, int parm, int &len);
 	void InvalidateCache();
@@ -153,6 +132,10 @@ public:
 	const char *GetLangName(const size_t langId);
 	// Check if a language exists
 	bool LangExists(const char *langName);
+	// Get the id of a language, -1 if it doesn't exist
+	int GetLangId(const char *langName);
+	// Language ids obtained with an other version must be looked up again
+	inline int GetLangsVersion(void) const { return m_LangsVersion; }
 
 	// When a language id in a format string in FormatAmxString is LANG_PLAYER, the glob id decides which language to take.
 	void SetDefLang(const int id);
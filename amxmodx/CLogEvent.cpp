@@ -19,9 +19,39 @@ NativeHandle<LogEventHook> LogEventHandles;
 LogEventsMngr::LogEventsMngr()
 {
 	logCurrent = logCounter = 0;
+	logArgc = 0;
+	logEventsNum = 0;
 	logcmplist = 0;
 	arelogevents = false;
 	memset(logevents, 0, sizeof(logevents));
+	memset(unindexed, 0, sizeof(unindexed));
+	memset(indexedArgs, 0, sizeof(indexedArgs));
+	memset(cmphash, 0, sizeof(cmphash));
+}
+
+static inline uint32_t HashLogText(const char* string, int length)
+{
+	// FNV-1a, same as cstrhash but bounded
+	uint32_t hash = 2166136261u;
+	while (length-- > 0)
+	{
+		hash ^= static_cast<unsigned char>(*string++);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static inline bool ContainsLogText(const char* string, int length, const char* text, int textLength)
+{
+	int i;
+	for (i = 0; i + textLength <= length; ++i)
+	{
+		if (!memcmp(string + i, text, textLength))
+			return true;
+	}
+
+	return false;
 }
 
 LogEventsMngr::~LogEventsMngr()
@@ -29,17 +59,36 @@ LogEventsMngr::~LogEventsMngr()
 	clearLogEvents();
 }
 
-int LogEventsMngr::CLogCmp::compareCondition(const char* string)
+int LogEventsMngr::CLogCmp::compareCondition(const char* string, int length)
 {
 	if (logid == parent->logCounter)
 		return result;
 	
 	logid = parent->logCounter;
-	
+
+	const int textLength = static_cast<int>(text.length());
 	if (in)
-		return result = strstr(string, text.chars()) ? 0 : 1;
-	
-	return result = strcmp(string,text.chars());
+		return result = ContainsLogText(string, length, text.chars(), textLength) ? 0 : 1;
+
+	if (length != textLength)
+		return result = 1;
+
+	return result = memcmp(string, text.chars(), length);
+}
+
+LogEventsMngr::CLogCmp* LogEventsMngr::findExactCondition(int pos)
+{
+	int length;
+	const char* arg = getLogArgSpan(pos, length);
+	const uint32_t hash = HashLogText(arg, length);
+
+	for (CLogCmp* c = cmphash[(hash + pos) & (LOGCMP_HASH_SIZE - 1)]; c; c = c->hashNext)
+	{
+		if (c->hash == hash && c->pos == pos && static_cast<int>(c->text.length()) == length && !memcmp(c->text.chars(), arg, length))
+			return c;
+	}
+
+	return nullptr;
 }
 
 LogEventsMngr::CLogCmp* LogEventsMngr::registerCondition(char* filter)
@@ -66,7 +115,17 @@ LogEventsMngr::CLogCmp* LogEventsMngr::registerCondition(char* filter)
 		c = c->next;
 	}
 	
-	return logcmplist = new CLogCmp(filter, in, pos, logcmplist, this);
+	c = logcmplist = new CLogCmp(filter, in, pos, logcmplist, this);
+	if (!in)
+	{
+		c->hash = HashLogText(c->text.chars(), c->text.length());
+
+		CLogCmp** bucket = &cmphash[(c->hash + pos) & (LOGCMP_HASH_SIZE - 1)];
+		c->hashNext = *bucket;
+		*bucket = c;
+	}
+
+	return c;
 }
 
 void LogEventsMngr::CLogEvent::registerFilter(char* filter)
@@ -79,6 +138,7 @@ void LogEventsMngr::CLogEvent::registerFilter(char* filter)
 		if (c->argnum == cmp->pos)
 		{
 			c->list = new LogCondEle(cmp, c->list);
+			parent->indexLogEvent(this);
 			return;
 		}
 	}
@@ -89,6 +149,59 @@ void LogEventsMngr::CLogEvent::registerFilter(char* filter)
 		return;
 
 	filters = new LogCond(cmp->pos, aa, filters);
+
+	// a new argument may give us a better key
+	parent->indexLogEvent(this);
+}
+
+void LogEventsMngr::unlinkLogEvent(CLogEvent* a)
+{
+	CLogEvent** d = a->key ? &a->key->indexed[a->argc] : &unindexed[a->argc];
+	while (*d)
+	{
+		if (*d == a)
+		{
+			*d = a->indexNext;
+			break;
+		}
+
+		d = &(*d)->indexNext;
+	}
+
+	a->indexNext = nullptr;
+	a->key = nullptr;
+}
+
+void LogEventsMngr::indexLogEvent(CLogEvent* a)
+{
+	// key on an argument that has to match one exact text; several texts
+	// for an argument are OR'ed, so such arguments can't be keyed on
+	CLogCmp* key = nullptr;
+	for (LogCond* c = a->filters; c; c = c->next)
+	{
+		if (!c->list->next && !c->list->cmp->in)
+		{
+			key = c->list->cmp;
+			break;
+		}
+	}
+
+	if (a->key == key && (a->key || a->indexNext || unindexed[a->argc] == a))
+		return;
+
+	unlinkLogEvent(a);
+	a->key = key;
+
+	if (key)
+		indexedArgs[a->argc] |= (1 << key->pos);
+
+	// chains stay sorted by registration order
+	CLogEvent** d = key ? &key->indexed[a->argc] : &unindexed[a->argc];
+	while (*d && (*d)->order < a->order)
+		d = &(*d)->indexNext;
+
+	a->indexNext = *d;
+	*d = a;
 }
 
 void LogEventsMngr::setLogString(const char* frmt, va_list& vaptr)
@@ -131,38 +244,43 @@ void LogEventsMngr::setLogString(const char* frmt, ...)
 
 void LogEventsMngr::parseLogString()
 {
-	register const char* b = logString;
-	register int a;
+	const char* b = logString;
+	const char* start;
+	const char* end;
 	
 	while (*b && logArgc < MAX_LOGARGS)
 	{
-		a = 0;
-		
 		if (*b == '"')
 		{
-			++b;
+			start = ++b;
 			
-			while (*b && *b != '"' && a < 127) 
-				logArgs[logArgc][a++] = *b++;
+			while (*b && *b != '"') 
+				++b;
 			
-			logArgs[logArgc++][a] = 0;
-			if (*b) b+=2; // thanks to double terminator
+			end = b;
+			if (*b && *++b) ++b; // thanks to double terminator
 		}
 		else if (*b == '(')
 		{
-			++b;
+			start = ++b;
 			
-			while (*b && *b != ')' && a < 127) 
-				logArgs[logArgc][a++] = *b++;
+			while (*b && *b != ')') 
+				++b;
 			
-			logArgs[logArgc++][a] = 0;
-			if (*b) b+=2;
+			end = b;
+			if (*b && *++b) ++b;
 		} else {
-			while (*b && *b != '(' && *b != '"' && a < 127) 
-			logArgs[logArgc][a++] = *b++;
-			if (*b) --a;
-			logArgs[logArgc++][a] = 0;
+			start = b;
+
+			while (*b && *b != '(' && *b != '"') 
+				++b;
+
+			end = b;
+			if (*b) --end;
 		}
+
+		logArgs[logArgc].offset = static_cast<int>(start - logString);
+		logArgs[logArgc++].length = static_cast<int>(end - start);
 	}
 }
 
@@ -186,7 +304,7 @@ int LogEventsMngr::registerLogEvent(CPluginMngr::CPlugin* plugin, int func, int
 		d = &(*d)->next;
 	}
 
-	auto logevent = new CLogEvent(plugin, func, this);
+	auto logevent = new CLogEvent(plugin, func, pos, logEventsNum++, this);
 	auto handle = LogEventHandles.create(logevent);
 
 	if (!handle)
@@ -195,51 +313,95 @@ int LogEventsMngr::registerLogEvent(CPluginMngr::CPlugin* plugin, int func, int
 	}
 
 	*d = logevent;
+	indexLogEvent(logevent);
 
 	return handle;
 }
 
 void LogEventsMngr::executeLogEvents()
 {
-	bool valid;
+	// candidates: events keyed on one of this line's arguments, and the ones that have no key
+	CLogEvent* lists[MAX_LOGARGS + 1];
+	int count = 0;
 
-	for (CLogEvent* a = logevents[logArgc]; a; a = a->next)
+	if (unindexed[logArgc])
+		lists[count++] = unindexed[logArgc];
+
+	const int args = indexedArgs[logArgc];
+	CLogCmp* cmp;
+	int i;
+
+	for (i = 0; i < MAX_LOGARGS; ++i)
 	{
-		if (a->m_State != FSTATE_ACTIVE)
-		{
+		if (!(args & (1 << i)))
 			continue;
-		}
 
-		valid = true;
+		cmp = findExactCondition(i);
+		if (cmp && cmp->indexed[logArgc])
+			lists[count++] = cmp->indexed[logArgc];
+	}
+
+	// walk all chains at once, in registration order
+	CLogEvent* a;
+	int best;
 
-		for (CLogEvent::LogCond* b = a->filters; b; b = b->next)
+	while (true)
+	{
+		best = -1;
+		for (i = 0; i < count; ++i)
 		{
-			valid = false;
+			if (lists[i] && (best == -1 || lists[i]->order < lists[best]->order))
+				best = i;
+		}
 
-			for (CLogEvent::LogCondEle* c = b->list; c; c = c->next)
-			{
-				if (c->cmp->compareCondition(logArgs[b->argnum]) == 0)
-				{
-					valid = true;
-					break;
-				}
-			}
+		if (best == -1)
+			break;
 
-			if (!valid)
-				break;
-		}
+		a = lists[best];
+		lists[best] = a->indexNext;
 
-		if (valid)
+		if (a->m_State == FSTATE_ACTIVE && isValidLogEvent(a))
 		{
 			executeForwards(a->func);
 		}
 	}
 }
 
+bool LogEventsMngr::isValidLogEvent(CLogEvent* a)
+{
+	bool valid;
+	const char* arg;
+	int length;
+
+	for (CLogEvent::LogCond* b = a->filters; b; b = b->next)
+	{
+		valid = false;
+		arg = getLogArgSpan(b->argnum, length);
+
+		for (CLogEvent::LogCondEle* c = b->list; c; c = c->next)
+		{
+			if (c->cmp->compareCondition(arg, length) == 0)
+			{
+				valid = true;
+				break;
+			}
+		}
+
+		if (!valid)
+			return false;
+	}
+
+	return true;
+}
+
 void LogEventsMngr::clearLogEvents()
 {
 	logCurrent = logCounter = 0;
+	logEventsNum = 0;
 	arelogevents = false;
+	memset(unindexed, 0, sizeof(unindexed));
+	memset(indexedArgs, 0, sizeof(indexedArgs));
+	memset(cmphash, 0, sizeof(cmphash));
 	
 	for (int i = 0; i < MAX_LOGARGS + 1; ++i)
 	{
@@ -289,35 +451,12 @@ LogEventsMngr::CLogEvent::~CLogEvent()
 
 LogEventsMngr::CLogEvent *LogEventsMngr::getValidLogEvent(CLogEvent * a)
 {
-	bool valid;
-	
 	while (a)
 	{
-		valid = true;
-		
-		for (CLogEvent::LogCond* b = a->filters; b; b = b->next)
-		{
-			valid = false;
+		if (isValidLogEvent(a))
+			return a;
 
-			for (CLogEvent::LogCondEle* c = b->list; c; c = c->next)
-			{
-				if (c->cmp->compareCondition(logArgs[b->argnum]) == 0)
-				{
-					valid = true;
-					break;
-				}
-			}
-			
-			if (!valid) break;
-		}
-		
-		if (!valid)
-		{
-			a = a->next;
-			continue;
-		}
-		
-		return a;
+		a = a->next;
 	}
 	
 	return 0;
@@ -19,10 +19,19 @@
 // class LogEventsMngr
 // *****************************************************
 
+#define LOGCMP_HASH_SIZE 256
+
 class LogEventsMngr
 {
+	// an argument of the current line, kept as a span of logString
+	struct LogArg
+	{
+		int offset;
+		int length;
+	};
+
 	char logString[256];
-	char logArgs[MAX_LOGARGS][128];
+	LogArg logArgs[MAX_LOGARGS];
 	int logArgc;
 	int logCounter;
 	int logCurrent;
@@ -48,8 +57,11 @@ public:
 		int pos;
 		int result;
 		bool in;
+		uint32_t hash;
 		
 		CLogCmp *next;
+		CLogCmp *hashNext;						// chain in cmphash, exact conditions only
+		CLogEvent *indexed[MAX_LOGARGS + 1];	// per argc, events keyed on this condition
 		
 		CLogCmp(const char* s, bool r, int p, CLogCmp *n, LogEventsMngr* mg) : text(s)
 		{
@@ -58,14 +70,18 @@ public:
 			parent = mg;
 			in = r;
 			next = n;
+			hashNext = nullptr;
+			hash = 0;
+			memset(indexed, 0, sizeof(indexed));
 		}
 	
 	public:
-		int compareCondition(const char* string);
+		int compareCondition(const char* string, int length);
 	};
 
 private:
 	CLogCmp *logcmplist;
+	CLogCmp *cmphash[LOGCMP_HASH_SIZE];		// exact conditions by (pos, text)
 public:
 
 	class CLogEvent
@@ -93,6 +109,8 @@ public:
 		CPluginMngr::CPlugin *plugin;
 		
 		int func;
+		int argc;
+		int order;								// registration order, dispatch follows it
 		
 		LogCond *filters;
 		LogEventsMngr* parent;
@@ -100,7 +118,9 @@ public:
 		ForwardState m_State;
 
 		CLogEvent *next;
-		CLogEvent(CPluginMngr::CPlugin *p, int f, LogEventsMngr* ppp) : plugin(p), func(f), filters(nullptr), parent(ppp), m_State(FSTATE_ACTIVE), next(nullptr) {}
+		CLogCmp *key;							// condition we are indexed under, null if none
+		CLogEvent *indexNext;					// next event in the same index chain
+		CLogEvent(CPluginMngr::CPlugin *p, int f, int a, int o, LogEventsMngr* ppp) : plugin(p), func(f), argc(a), order(o), filters(nullptr), parent(ppp), m_State(FSTATE_ACTIVE), next(nullptr), key(nullptr), indexNext(nullptr) {}
 		~CLogEvent();
 	public:
 		inline CPluginMngr::CPlugin *getPlugin() { return plugin; }
@@ -111,8 +131,26 @@ public:
 
 private:
 	CLogEvent *logevents[MAX_LOGARGS + 1];
+	CLogEvent *unindexed[MAX_LOGARGS + 1];	// per argc, events that must be checked on every line
+	int indexedArgs[MAX_LOGARGS + 1];		// per argc, bits of the args some event is keyed on
+	int logEventsNum;
 	CLogEvent *getValidLogEvent(CLogEvent * a);
 	CLogCmp* registerCondition(char* filter);
+	CLogCmp* findExactCondition(int pos);
+	bool isValidLogEvent(CLogEvent* a);
+	void indexLogEvent(CLogEvent* a);
+	void unlinkLogEvent(CLogEvent* a);
+	inline const char* getLogArgSpan(int i, int& length)
+	{
+		if (i < 0 || i >= logArgc)
+		{
+			length = 0;
+			return "";
+		}
+
+		length = logArgs[i].length;
+		return logString + logArgs[i].offset;
+	}
 	
 	void clearConditions();
 public:
@@ -130,7 +168,7 @@ public:
 	
 	inline const char* getLogString() { return logString; }
 	inline int getLogArgNum() { return logArgc; }
-	inline const char* getLogArg(int i) { return (i < 0 || i >= logArgc) ? "" : logArgs[i]; }
+	inline const char* getLogArg(int i, int& length) { return getLogArgSpan(i, length); }	// not null terminated
 	void clearLogEvents();
 
 	class iterator
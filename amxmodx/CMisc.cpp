@@ -34,6 +34,10 @@ void CPlayer::Init(edict_t* e, const int i)
 	menuexpire = 0.0;
 	newmenu = -1;
 
+	lang[0] = '\0';
+	langId = -1;
+	langVersion = -1;
+
 	death_weapon = nullptr;
 	name = nullptr;
 	ip = nullptr;
@@ -69,6 +69,10 @@ public:
 
 	float channels[5];
 	cell hudmap[5];
+
+	char lang[8];		// "lang" setinfo langId was looked up for
+	int langId;
+	int langVersion;	// CLangMngr::GetLangsVersion() at that time
 	
 	Vector lastTrace;
 	Vector lastHit;
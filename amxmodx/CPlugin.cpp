@@ -16,6 +16,10 @@
 #include "libraries.h"
 #include <amxmodx_version.h>
 #include "engine_strucs.h"
+#include <atomic>
+#include <thread>
+
+#define PLUGIN_READ_THREADS 8	// most workers inflating plugins at once
 
 extern const char *no_function;
 
@@ -520,67 +524,60 @@ AutoConfig *CPluginMngr::CPlugin::GetConfig(size_t i)
 
 
 
-char *CPluginMngr::ReadIntoOrFromCache(const char *file, size_t &bufsize)
+char *CPluginMngr::ReadPlugin(const char *file, size_t &bufsize, bool quiet)
 {
-	List<plcache_entry *>::iterator iter;
-	plcache_entry *pl;
+	CAmxxReader reader(file, sizeof(cell));
+	reader.SetQuiet(quiet);
 
-	for (iter=m_plcache.begin(); iter!=m_plcache.end(); iter++)
-	{
-		pl = (*iter);
-		if (pl->path.compare(file) == 0)
-		{
-			bufsize = pl->bufsize;
-			return pl->buffer;
-		}
-	}
+	if (reader.GetStatus() != CAmxxReader::Err_None)
+		return NULL;
 
-	pl = new plcache_entry;
+	bufsize = reader.GetBufferSize();
+	if (!bufsize)
+		return NULL;
 
-	pl->file = new CAmxxReader(file, sizeof(cell));
-	pl->buffer = NULL;
-	if (pl->file->GetStatus() != CAmxxReader::Err_None)
-	{
-		delete pl->file;
-		delete pl;
+	char *buffer = new (std::nothrow) char[bufsize];
+	if (!buffer)
 		return NULL;
-	}
 
-	pl->bufsize = pl->file->GetBufferSize();
-	if (pl->bufsize)
+	if (reader.GetSection(buffer) != CAmxxReader::Err_None || reader.GetStatus() != CAmxxReader::Err_None)
 	{
-		pl->buffer = new char[pl->bufsize];
-		pl->file->GetSection(pl->buffer);
+		delete [] buffer;
+		return NULL;
 	}
 
-	if (!pl->buffer || pl->file->GetStatus() != CAmxxReader::Err_None)
+	return buffer;
+}
+
+char *CPluginMngr::ReadIntoOrFromCache(const char *file, size_t &bufsize)
+{
+	plcache_entry *pl;
+
+	if (m_plcache.retrieve(file, &pl))
 	{
-		delete [] pl->buffer;
-		delete pl->file;
-		delete pl;
-		return NULL;
+		bufsize = pl->bufsize;
+		return pl->buffer;
 	}
 
-	pl->path = file;
+	char *buffer = ReadPlugin(file, bufsize, false);
+	if (!buffer)
+		return NULL;
 
-	bufsize = pl->bufsize;
+	pl = new plcache_entry;
+	pl->buffer = buffer;
+	pl->bufsize = bufsize;
 
-	m_plcache.push_back(pl);
+	m_plcache.insert(file, pl);
 
-	return pl->buffer;
+	return buffer;
 }
 
 void CPluginMngr::InvalidateCache()
 {
-	List<plcache_entry *>::iterator iter;
-	plcache_entry *pl;
-
-	for (iter=m_plcache.begin(); iter!=m_plcache.end(); iter++)
+	for (StringHashMap<plcache_entry *>::iterator iter = m_plcache.iter(); !iter.empty(); iter.next())
 	{
-		pl = (*iter);
-		delete [] pl->buffer;
-		delete pl->file;
-		delete pl;
+		delete [] (*iter).value->buffer;
+		delete (*iter).value;
 	}
 
 	m_plcache.clear();
@@ -588,21 +585,89 @@ void CPluginMngr::InvalidateCache()
 
 void CPluginMngr::InvalidateFileInCache(const char *file, bool freebuf)
 {
-	List<plcache_entry *>::iterator iter;
-	plcache_entry *pl;
+	StringHashMap<plcache_entry *>::Result r = m_plcache.find(file);
+
+	if (!r.found())
+		return;
+
+	if (freebuf)
+		delete [] r->value->buffer;
+	delete r->value;
 
-	for (iter=m_plcache.begin(); iter!=m_plcache.end(); iter++)
+	m_plcache.remove(r);
+}
+
+void CPluginMngr::ReadPending()
+{
+	struct PendingRead
 	{
-		pl = (*iter);
-		if (pl->path.compare(file) == 0)
+		const char *path;
+		char *buffer;
+		size_t bufsize;
+	};
+
+	ke::Vector<PendingRead> reads;
+	StringHashMap<bool> queued;
+	PendingRead read;
+	size_t i;
+
+	for (i = 0; i < m_plpending.length(); i++)
+	{
+		read.path = m_plpending[i].chars();
+		read.buffer = NULL;
+		read.bufsize = 0;
+
+		if (m_plcache.contains(read.path) || !queued.insert(read.path, true))
+			continue;
+
+		reads.append(read);
+	}
+
+	if (reads.empty())
+		return;
+
+	// Reading and inflating is all the time spent here and touches nothing shared,
+	// so spread it over a few threads; everything else stays on this one.
+	std::atomic<size_t> next(0);
+	auto worker = [&]()
+	{
+		size_t index;
+		while ((index = next++) < reads.length())
 		{
-			if (freebuf)
-				delete [] pl->buffer;
-			delete pl->file;
-			delete pl;
-			m_plcache.erase(iter);
-			return;
+			reads[index].buffer = ReadPlugin(reads[index].path, reads[index].bufsize, true);
 		}
+	};
+
+	size_t threads = std::thread::hardware_concurrency();
+	if (threads > PLUGIN_READ_THREADS)
+		threads = PLUGIN_READ_THREADS;
+	if (threads > reads.length())
+		threads = reads.length();
+
+	std::thread pool[PLUGIN_READ_THREADS];
+	for (i = 1; i < threads; i++)
+	{
+		pool[i] = std::thread(worker);
+	}
+
+	worker();
+
+	for (i = 1; i < threads; i++)
+	{
+		pool[i].join();
+	}
+
+	// Failed reads are left out, they are done again when loading and report their error then
+	for (i = 0; i < reads.length(); i++)
+	{
+		if (!reads[i].buffer)
+			continue;
+
+		plcache_entry *pl = new plcache_entry;
+		pl->buffer = reads[i].buffer;
+		pl->bufsize = reads[i].bufsize;
+
+		m_plcache.insert(reads[i].path, pl);
 	}
 }
 
@@ -786,8 +851,20 @@ void CPluginMngr::CALMFromFile(const char *file)
 
 		build_pathname_r(filename, sizeof(filename), "%s/%s", get_localinfo("amxx_pluginsdir", "addons/amxmodx/plugins"), pluginName);
 
-		CacheAndLoadModules(filename);
+		m_plpending.append(ke::AString(filename));
 	}
 
 	fclose(fp);
 }
+
+void CPluginMngr::CALMPending()
+{
+	ReadPending();
+
+	for (size_t i = 0; i < m_plpending.length(); i++)
+	{
+		CacheAndLoadModules(m_plpending[i].chars());
+	}
+
+	m_plpending.clear();
+}
@@ -16,6 +16,7 @@
 #include <amtl/am-string.h>
 #include <amtl/am-vector.h>
 #include <amtl/am-autoptr.h>
+#include <sm_stringhashmap.h>
 
 // *****************************************************
 // class CPluginMngr
@@ -158,18 +159,21 @@ public:
 public:
 	struct plcache_entry
 	{
-		CAmxxReader *file;
 		size_t bufsize;
 		char *buffer;
-		ke::AString path;
 	};
 	char *ReadIntoOrFromCache(const char *file, size_t &bufsize);
 	void InvalidateCache();
 	void InvalidateFileInCache(const char *file, bool freebuf);
 	void CacheAndLoadModules(const char *plugin);
 	void CALMFromFile(const char *file);
+	void CALMPending();
 private:
-	List<plcache_entry *> m_plcache;
+	static char *ReadPlugin(const char *file, size_t &bufsize, bool quiet);
+	void ReadPending();
+
+	StringHashMap<plcache_entry *> m_plcache;
+	ke::Vector<ke::AString> m_plpending;	// plugin paths queued by CALMFromFile, in list order
 	List<ke::AString *> m_BlockList;
 };
 
@@ -0,0 +1,309 @@
+// vim: set ts=4 sw=4 tw=99 noet:
+//
+// AMX Mod X, based on AMX Mod by Aleksander Naszko ("OLO").
+// Copyright (C) The AMX Mod X Development Team.
+//
+// This software is licensed under the GNU General Public License, version 3 or higher.
+// Additional exceptions apply. For full license details, see LICENSE.txt or visit:
+//     https://alliedmods.net/amxmodx-license
+
+#include "amxmodx.h"
+#include "CProfiler.h"
+#include <chrono>
+#include <clib.h>
+
+static inline uint64_t ProfilerNow(void)
+{
+	using std::chrono::steady_clock;
+	using std::chrono::duration_cast;
+	using std::chrono::nanoseconds;
+
+	return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+CProfiler::CProfiler(void)
+{
+	m_Active = false;
+	m_StartNs = 0;
+	m_ElapsedNs = 0;
+}
+
+void CProfiler::Start(void)
+{
+	if (m_Active)
+		return;
+
+	m_StartNs = ProfilerNow();
+	m_Active = true;
+}
+
+void CProfiler::Stop(void)
+{
+	if (!m_Active)
+		return;
+
+	m_Active = false;
+	m_ElapsedNs += ProfilerNow() - m_StartNs;
+}
+
+void CProfiler::Clear(void)
+{
+	m_Tables.clear();
+	m_Retired.clear();
+	m_ElapsedNs = 0;
+	if (m_Active)
+		m_StartNs = ProfilerNow();
+}
+
+CProfiler::ProfileEntry *CProfiler::getEntry(CPluginMngr::CPlugin *pPlugin, const cell index, const bool isNative)
+{
+	if (pPlugin == nullptr || index < 0)
+		return nullptr;
+
+	const size_t id = static_cast<size_t>(pPlugin->getId());
+	if (id >= m_Tables.length() && !m_Tables.resize(id + 1))
+		return nullptr;
+
+	ke::Vector<ProfileEntry> &entries = isNative ? m_Tables[id].natives : m_Tables[id].publics;
+	if (static_cast<size_t>(index) >= entries.length())
+	{
+		const size_t oldLength = entries.length();
+		if (!entries.resize(index + 1))
+			return nullptr;
+
+		size_t i;
+		for (i = oldLength; i < entries.length(); i++)
+		{
+			entries[i].isNative = isNative;
+			entries[i].calls = 0;
+			entries[i].totalNs = 0;
+			entries[i].maxNs = 0;
+		}
+	}
+
+	ProfileEntry *pEntry = &entries[index];
+	if (pEntry->name.length() == 0)
+	{
+		char name[sNAMEMAX + 1];
+		name[0] = '\0';
+
+		if (isNative)
+			amx_GetNative(pPlugin->getAMX(), index, name);
+		else
+			amx_GetPublic(pPlugin->getAMX(), index, name);
+
+		if (name[0] == '\0')
+			ke::SafeSprintf(name, sizeof(name), "Unknown_ID%d", index);
+
+		pEntry->name = name;
+		if (!isNative)
+			pEntry->plugin = pPlugin->getName();
+	}
+
+	return pEntry;
+}
+
+void CProfiler::record(ProfileEntry *pEntry, const uint64_t ns)
+{
+	pEntry->calls++;
+	pEntry->totalNs += ns;
+	if (ns > pEntry->maxNs)
+		pEntry->maxNs = ns;
+}
+
+int CProfiler::ExecPublic(CPluginMngr::CPlugin *pPlugin, AMX *amx, cell *retval, const int index)
+{
+	const uint64_t start = ProfilerNow();
+	const int err = amx_ExecPerf(amx, retval, index);
+	const uint64_t ns = ProfilerNow() - start;
+
+	// the public may have stopped the profiler itself
+	if (m_Active)
+	{
+		ProfileEntry *pEntry = getEntry(pPlugin, index, false);
+		if (pEntry != nullptr)
+			record(pEntry, ns);
+	}
+
+	return err;
+}
+
+cell CProfiler::CallNative(AMX *amx, const cell index, AMX_NATIVE func, cell *params)
+{
+	const uint64_t start = ProfilerNow();
+	const cell result = func(amx, params);
+	const uint64_t ns = ProfilerNow() - start;
+
+	if (m_Active)
+	{
+		ProfileEntry *pEntry = getEntry(g_plugins.findPluginFast(amx), index, true);
+		if (pEntry != nullptr)
+			record(pEntry, ns);
+	}
+
+	return result;
+}
+
+void CProfiler::OnPluginsUnloaded(void)
+{
+	size_t i, j;
+	for (i = 0; i < m_Tables.length(); i++)
+	{
+		for (j = 0; j < m_Tables[i].publics.length(); j++)
+		{
+			if (m_Tables[i].publics[j].calls)
+				m_Retired.append(m_Tables[i].publics[j]);
+		}
+
+		for (j = 0; j < m_Tables[i].natives.length(); j++)
+		{
+			if (m_Tables[i].natives[j].calls)
+				m_Retired.append(m_Tables[i].natives[j]);
+		}
+	}
+
+	m_Tables.clear();
+}
+
+struct ProfileLine
+{
+	const char *plugin;
+	const char *name;
+	bool isNative;
+	uint64_t calls;
+	uint64_t totalNs;
+	uint64_t maxNs;
+};
+
+static int SortProfileByName(const void *a, const void *b)
+{
+	const ProfileLine *first = static_cast<const ProfileLine*>(a);
+	const ProfileLine *second = static_cast<const ProfileLine*>(b);
+
+	if (first->isNative != second->isNative)
+		return first->isNative ? 1 : -1;
+
+	const int res = cstrcmp(first->plugin, second->plugin);
+	if (res != 0)
+		return res;
+
+	return cstrcmp(first->name, second->name);
+}
+
+static int SortProfileByTime(const void *a, const void *b)
+{
+	const ProfileLine *first = static_cast<const ProfileLine*>(a);
+	const ProfileLine *second = static_cast<const ProfileLine*>(b);
+
+	if (first->totalNs == second->totalNs)
+		return 0;
+
+	return (first->totalNs > second->totalNs) ? -1 : 1;
+}
+
+bool CProfiler::Dump(const char *reportPath, const char *csvPath)
+{
+	ke::Vector<ProfileLine> lines;
+	ProfileLine line;
+	size_t i, j;
+
+	// gather every entry that saw a call, current plugins and retired ones alike
+	const ke::Vector<ProfileEntry> *lists[2];
+	for (i = 0; i <= m_Tables.length(); i++)
+	{
+		if (i < m_Tables.length())
+		{
+			lists[0] = &m_Tables[i].publics;
+			lists[1] = &m_Tables[i].natives;
+		}
+		else
+		{
+			lists[0] = &m_Retired;
+			lists[1] = nullptr;
+		}
+
+		for (const ke::Vector<ProfileEntry> *list : lists)
+		{
+			if (list == nullptr)
+				continue;
+
+			for (j = 0; j < list->length(); j++)
+			{
+				const ProfileEntry &entry = list->at(j);
+				if (!entry.calls)
+					continue;
+
+				line.plugin = entry.plugin.chars();
+				line.name = entry.name.chars();
+				line.isNative = entry.isNative;
+				line.calls = entry.calls;
+				line.totalNs = entry.totalNs;
+				line.maxNs = entry.maxNs;
+				lines.append(line);
+			}
+		}
+	}
+
+	// merge duplicates (natives across plugins, publics across maps)
+	size_t count = 0;
+	if (!lines.empty())
+	{
+		qsort(lines.buffer(), lines.length(), sizeof(ProfileLine), SortProfileByName);
+
+		for (i = 1; i < lines.length(); i++)
+		{
+			ProfileLine &last = lines[count];
+			if (SortProfileByName(&last, &lines[i]) == 0)
+			{
+				last.calls += lines[i].calls;
+				last.totalNs += lines[i].totalNs;
+				if (lines[i].maxNs > last.maxNs)
+					last.maxNs = lines[i].maxNs;
+			}
+			else
+				lines[++count] = lines[i];
+		}
+
+		count++;
+		qsort(lines.buffer(), count, sizeof(ProfileLine), SortProfileByTime);
+	}
+
+	FILE *report = fopen(reportPath, "wt");
+	if (report == nullptr)
+		return false;
+
+	FILE *csv = fopen(csvPath, "wt");
+	if (csv == nullptr)
+	{
+		fclose(report);
+		return false;
+	}
+
+	uint64_t elapsedNs = m_ElapsedNs;
+	if (m_Active)
+		elapsedNs += ProfilerNow() - m_StartNs;
+
+	fprintf(report, "AMX Mod X profile, %.3f seconds sampled\n\n", static_cast<double>(elapsedNs) / 1000000000.0);
+	fprintf(report, "%-6s %-24.23s %-32.31s %10s %12s %10s %10s\n", "type", "plugin", "function", "calls", "total ms", "avg us", "max us");
+	fprintf(csv, "type,plugin,function,calls,total_us,avg_us,max_us\n");
+
+	const char *type;
+	double totalUs, maxUs, avgUs;
+	for (i = 0; i < count; i++)
+	{
+		const ProfileLine &entry = lines[i];
+		type = entry.isNative ? "native" : "public";
+		totalUs = static_cast<double>(entry.totalNs) / 1000.0;
+		maxUs = static_cast<double>(entry.maxNs) / 1000.0;
+		avgUs = totalUs / static_cast<double>(entry.calls);
+
+		fprintf(report, "%-6s %-24.23s %-32.31s %10llu %12.3f %10.3f %10.3f\n", type, entry.plugin, entry.name,
+				static_cast<unsigned long long>(entry.calls), totalUs / 1000.0, avgUs, maxUs);
+		fprintf(csv, "%s,%s,%s,%llu,%.3f,%.3f,%.3f\n", type, entry.plugin, entry.name,
+				static_cast<unsigned long long>(entry.calls), totalUs, avgUs, maxUs);
+	}
+
+	fclose(report);
+	fclose(csv);
+	return true;
+}
@@ -0,0 +1,67 @@
+// vim: set ts=4 sw=4 tw=99 noet:
+//
+// AMX Mod X, based on AMX Mod by Aleksander Naszko ("OLO").
+// Copyright (C) The AMX Mod X Development Team.
+//
+// This software is licensed under the GNU General Public License, version 3 or higher.
+// Additional exceptions apply. For full license details, see LICENSE.txt or visit:
+//     https://alliedmods.net/amxmodx-license
+
+/*
+	CProfiler.h
+	call counts and wall time per (plugin, public) and per native,
+	controlled with "amxx prof start|stop|dump"
+
+	Stats are kept per plugin id and per public/native index so recording is two
+	vector lookups; names are resolved the first time an entry is hit and entries
+	are merged by name when dumping.
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+class CProfiler
+{
+	struct ProfileEntry
+	{
+		ke::AString plugin;
+		ke::AString name;
+		bool isNative;
+		uint64_t calls;
+		uint64_t totalNs;
+		uint64_t maxNs;
+	};
+
+	struct ProfileTable
+	{
+		ke::Vector<ProfileEntry> publics;
+		ke::Vector<ProfileEntry> natives;
+	};
+
+	bool m_Active;
+	uint64_t m_StartNs;
+	uint64_t m_ElapsedNs;
+	ke::Vector<ProfileTable> m_Tables;		// indexed by plugin id
+	ke::Vector<ProfileEntry> m_Retired;		// stats of plugins from previous maps
+
+	ProfileEntry *getEntry(CPluginMngr::CPlugin *pPlugin, const cell index, const bool isNative);
+	void record(ProfileEntry *pEntry, const uint64_t ns);
+public:
+	CProfiler(void);
+
+	// the only thing checked on hot paths while profiling is off
+	inline bool IsActive(void) const { return m_Active; }
+
+	void Start(void);
+	void Stop(void);
+	void Clear(void);
+	bool Dump(const char *reportPath, const char *csvPath);
+
+	int ExecPublic(CPluginMngr::CPlugin *pPlugin, AMX *amx, cell *retval, const int index);
+	cell CallNative(AMX *amx, const cell index, AMX_NATIVE func, cell *params);
+
+	// plugin ids get reused on map change, so keep what was collected so far under names
+	void OnPluginsUnloaded(void);
+};
+
+#endif //PROFILER_H
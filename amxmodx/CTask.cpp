@@ -98,49 +98,41 @@ void CTaskMngr::CTask::resetNextExecTime(const float fCurrentTime)
 		m_fNextExecTime = fCurrentTime + m_fBase;
 }
 
-void CTaskMngr::CTask::executeIfRequired(const float fCurrentTime, const float fTimeLimit, const float fTimeLeft)
+bool CTaskMngr::CTask::isDue(const float fCurrentTime, const float fTimeLimit, const float fTimeLeft) const
 {
-	bool execute = false;
 	if (m_bAfterStart)
-	{
-		if (fCurrentTime - fTimeLeft + 1.0f >= m_fBase)
-			execute = true;
-	}
-	else if (m_bBeforeEnd)
-	{
-		if (fTimeLimit != 0.0f && (fTimeLeft + fTimeLimit * 60.0f) - fCurrentTime - 1.0f <= m_fBase)
-			execute = true;
-	}
-	else if (m_fNextExecTime <= fCurrentTime)
-		execute = true;
+		return fCurrentTime - fTimeLeft + 1.0f >= m_fBase;
 
-	if (execute)
-	{
-		//only bother calling if we have something to call
-		if (!(m_bLoop && !m_iRepeat))
-		{
-			m_bInExecute = true;
-			if (m_iParamLen) // call with parameters
-				executeForwards(m_iFunc, prepareCellArray(m_pParams, m_iParamLen), m_iId);
-			else
-				executeForwards(m_iFunc, m_iId);
-			m_bInExecute = false;
-		}
+	if (m_bBeforeEnd)
+		return fTimeLimit != 0.0f && (fTimeLeft + fTimeLimit * 60.0f) - fCurrentTime - 1.0f <= m_fBase;
 
-		if (isFree())
-			return;
+	return m_fNextExecTime <= fCurrentTime;
+}
 
-		// set new exec time OR remove the task if needed
-		if (m_bLoop)
-		{
-			if (m_iRepeat != -1 && --m_iRepeat <= 0)
-				clear();
-			else
-				m_fNextExecTime += m_fBase;
-		}
+bool CTaskMngr::CTask::execute(void)
+{
+	//only bother calling if we have something to call
+	if (!(m_bLoop && !m_iRepeat))
+	{
+		m_bInExecute = true;
+		if (m_iParamLen) // call with parameters
+			executeForwards(m_iFunc, prepareCellArray(m_pParams, m_iParamLen), m_iId);
 		else
-			clear();
+			executeForwards(m_iFunc, m_iId);
+		m_bInExecute = false;
+	}
+
+	if (isFree())
+		return false;
+
+	// set new exec time OR let the manager remove the task
+	if (m_bLoop && (m_iRepeat == -1 || --m_iRepeat > 0))
+	{
+		m_fNextExecTime += m_fBase;
+		return true;
 	}
+
+	return false;
 }
 
 CTaskMngr::CTask::CTask(void)
@@ -158,6 +150,9 @@ CTaskMngr::CTask::CTask(void)
 	m_fNextExecTime = 0.0f;
 	m_iParamLen = 0;
 	m_pParams = nullptr;
+	m_iHeapIndex = -1;
+	m_bPending = false;
+	m_pNextInBucket = nullptr;
 }
 
 CTaskMngr::CTask::~CTask(void)
@@ -172,6 +167,7 @@ CTaskMngr::CTaskMngr(void)
 	m_pTmr_CurrentTime = nullptr;
 	m_pTmr_TimeLimit = nullptr;
 	m_pTmr_TimeLeft = nullptr;
+	m_iIndexed = 0u;
 }
 
 CTaskMngr::~CTaskMngr(void)
@@ -188,84 +184,392 @@ void CTaskMngr::registerTimers(float *pCurrentTime, float *pTimeLimit, float *pT
 
 void CTaskMngr::registerTask(CPluginMngr::CPlugin *pPlugin, const int iFunc, const int iFlags, const cell iId, const float fBase, const int iParamsLen, const cell *pParams, const int iRepeat)
 {
-	// first, search for free tasks
-	for (auto &task : m_Tasks)
+	CTask *pTask;
+
+	// first, reuse a free task
+	if (!m_FreeTasks.empty())
+		pTask = m_FreeTasks.popCopy();
+	else
 	{
-		if (task->isFree() && !task->inExecute())
-		{
-			// found: reuse it
-			task->set(pPlugin, iFunc, iFlags, iId, fBase, iParamsLen, pParams, iRepeat, *m_pTmr_CurrentTime);
+		// not found: make a new one
+		auto task = ke::AutoPtr<CTask>(new(std::nothrow) CTask);
+		if (task == nullptr)
 			return;
-		}
+
+		pTask = task.get();
+		m_Tasks.append(ke::Move(task));
 	}
 
-	// not found: make a new one
-	auto task = ke::AutoPtr<CTask>(new(std::nothrow) CTask);
-	if (task == nullptr)
-		return;
-		
-	task->set(pPlugin, iFunc, iFlags, iId, fBase, iParamsLen, pParams, iRepeat, *m_pTmr_CurrentTime);
-	m_Tasks.append(ke::Move(task));
+	pTask->set(pPlugin, iFunc, iFlags, iId, fBase, iParamsLen, pParams, iRepeat, *m_pTmr_CurrentTime);
+	indexAdd(pTask);
+	schedule(pTask);
+
+	const size_t iPlugin = static_cast<size_t>(pPlugin->getId());
+	while (m_PluginTaskCounts.length() <= iPlugin)
+		m_PluginTaskCounts.append(0);
+
+	m_PluginTaskCounts[iPlugin]++;
 }
 
 int CTaskMngr::removeTasks(const int iId, AMX *pAmx)
 {
 	int i = 0;
-	for (auto &task : m_Tasks)
+	if (pAmx == nullptr)
+	{
+		for (auto &task : m_Tasks)
+		{
+			if (task->match(iId, pAmx))
+			{
+				releaseTask(task.get());
+				++i;
+			}
+		}
+
+		return i;
+	}
+
+	CTask *pTask = indexFirst(pAmx, iId), *pNext;
+	while (pTask != nullptr)
 	{
-		if (task->match(iId, pAmx))
+		pNext = pTask->getNextInBucket();
+		if (pTask->match(iId, pAmx))
 		{
-			task->clear();
+			releaseTask(pTask);
 			++i;
 		}
+
+		pTask = pNext;
 	}
-	
+
 	return i;
 }
 
 int CTaskMngr::changeTasks(const int iId, AMX *pAmx, const float fNewBase)
 {
 	int i = 0;
-	
-	for (auto &task : m_Tasks)
+	if (pAmx == nullptr)
+	{
+		for (auto &task : m_Tasks)
+		{
+			if (task->match(iId, pAmx))
+			{
+				task->changeBase(fNewBase);
+				task->resetNextExecTime(*m_pTmr_CurrentTime);
+				heapUpdate(task.get());
+				++i;
+			}
+		}
+
+		return i;
+	}
+
+	CTask *pTask;
+	for (pTask = indexFirst(pAmx, iId); pTask != nullptr; pTask = pTask->getNextInBucket())
 	{
-		if (task->match(iId, pAmx))
+		if (pTask->match(iId, pAmx))
 		{
-			task->changeBase(fNewBase);
-			task->resetNextExecTime(*m_pTmr_CurrentTime);
+			pTask->changeBase(fNewBase);
+			pTask->resetNextExecTime(*m_pTmr_CurrentTime);
+			heapUpdate(pTask);
 			++i;
 		}
 	}
-	
+
 	return i;
 }
 
 bool CTaskMngr::taskExists(const int iId, AMX *pAmx)
 {
-	for (auto &task : m_Tasks)
+	if (pAmx == nullptr)
 	{
-		if (task->match(iId, pAmx))
+		for (auto &task : m_Tasks)
+		{
+			if (task->match(iId, pAmx))
+				return true;
+		}
+
+		return false;
+	}
+
+	CTask *pTask;
+	for (pTask = indexFirst(pAmx, iId); pTask != nullptr; pTask = pTask->getNextInBucket())
+	{
+		if (pTask->match(iId, pAmx))
 			return true;
 	}
 
 	return false;
 }
 
+int CTaskMngr::getTaskCount(CPluginMngr::CPlugin *pPlugin) const
+{
+	const size_t iPlugin = static_cast<size_t>(pPlugin->getId());
+	if (iPlugin >= m_PluginTaskCounts.length())
+		return 0;
+
+	return m_PluginTaskCounts[iPlugin];
+}
+
 void CTaskMngr::startFrame(void)
 {
-	size_t i;
-	auto lastSize = m_Tasks.length();
-	for (i = 0u; i < lastSize; i++)
+	const float fCurrentTime = *m_pTmr_CurrentTime;
+	const float fTimeLimit = *m_pTmr_TimeLimit;
+	const float fTimeLeft = *m_pTmr_TimeLeft;
+
+	// collect everything that is due first, so tasks registered from a callback wait for the next frame
+	m_DueTasks.clear();
+	while (!m_Heap.empty() && m_Heap[0]->getNextExecTime() <= fCurrentTime)
 	{
-		auto &task = m_Tasks[i];
-		if (task->isFree())
+		CTask *pTask = m_Heap[0];
+		heapRemove(pTask);
+		pTask->setPending(true);
+		m_DueTasks.append(pTask);
+	}
+
+	size_t i = 0u;
+	while (i < m_MapTimerTasks.length())
+	{
+		CTask *pTask = m_MapTimerTasks[i];
+		if (!pTask->isDue(fCurrentTime, fTimeLimit, fTimeLeft))
+		{
+			i++;
 			continue;
+		}
 
-		task->executeIfRequired(*m_pTmr_CurrentTime, *m_pTmr_TimeLimit, *m_pTmr_TimeLeft);
+		m_MapTimerTasks[i] = m_MapTimerTasks.back();
+		m_MapTimerTasks.pop();
+		pTask->setPending(true);
+		m_DueTasks.append(pTask);
 	}
+
+	for (i = 0u; i < m_DueTasks.length(); i++)
+	{
+		CTask *pTask = m_DueTasks[i];
+
+		// an earlier callback may have removed or changed this one
+		if (!pTask->isFree() && pTask->isDue(fCurrentTime, fTimeLimit, fTimeLeft))
+		{
+			if (!pTask->execute() && !pTask->isFree())
+				forgetTask(pTask);
+		}
+
+		pTask->setPending(false);
+		if (pTask->isFree())
+			m_FreeTasks.append(pTask);
+		else
+			schedule(pTask);
+	}
+
+	m_DueTasks.clear();
 }
 
 void CTaskMngr::clear(void)
 {
+	m_DueTasks.clear();
+	m_MapTimerTasks.clear();
+	m_Heap.clear();
+	m_FreeTasks.clear();
+	m_Buckets.clear();
+	m_iIndexed = 0u;
+	m_PluginTaskCounts.clear();
 	m_Tasks.clear();
 }
+
+void CTaskMngr::schedule(CTask *pTask)
+{
+	if (pTask->followsMapTimer())
+		m_MapTimerTasks.append(pTask);
+	else
+		heapPush(pTask);
+}
+
+void CTaskMngr::unschedule(CTask *pTask)
+{
+	if (pTask->getHeapIndex() != -1)
+	{
+		heapRemove(pTask);
+		return;
+	}
+
+	size_t i;
+	for (i = 0u; i < m_MapTimerTasks.length(); i++)
+	{
+		if (m_MapTimerTasks[i] == pTask)
+		{
+			m_MapTimerTasks[i] = m_MapTimerTasks.back();
+			m_MapTimerTasks.pop();
+			return;
+		}
+	}
+}
+
+void CTaskMngr::releaseTask(CTask *pTask)
+{
+	unschedule(pTask);
+	forgetTask(pTask);
+
+	// pending tasks are given back by startFrame once it is done with them
+	if (!pTask->isPending())
+		m_FreeTasks.append(pTask);
+}
+
+void CTaskMngr::forgetTask(CTask *pTask)
+{
+	const size_t iPlugin = static_cast<size_t>(pTask->getPlugin()->getId());
+	if (iPlugin < m_PluginTaskCounts.length())
+		m_PluginTaskCounts[iPlugin]--;
+
+	indexRemove(pTask);
+	pTask->clear();
+}
+
+static inline size_t HashTaskKey(AMX *pAmx, const cell iId)
+{
+	return static_cast<size_t>(reinterpret_cast<uintptr_t>(pAmx) >> 4) ^ (static_cast<size_t>(iId) * 2654435761u);
+}
+
+CTaskMngr::CTask *CTaskMngr::indexFirst(AMX *pAmx, const cell iId) const
+{
+	if (m_Buckets.empty())
+		return nullptr;
+
+	return m_Buckets[HashTaskKey(pAmx, iId) & (m_Buckets.length() - 1u)];
+}
+
+void CTaskMngr::indexAdd(CTask *pTask)
+{
+	if (m_iIndexed >= m_Buckets.length())
+		indexGrow();
+
+	CTask *&pHead = m_Buckets[HashTaskKey(pTask->getAMX(), pTask->getTaskId()) & (m_Buckets.length() - 1u)];
+	pTask->setNextInBucket(pHead);
+	pHead = pTask;
+	m_iIndexed++;
+}
+
+void CTaskMngr::indexRemove(CTask *pTask)
+{
+	if (m_Buckets.empty())
+		return;
+
+	CTask *&pHead = m_Buckets[HashTaskKey(pTask->getAMX(), pTask->getTaskId()) & (m_Buckets.length() - 1u)];
+	CTask *pPrev = nullptr, *pCur;
+	for (pCur = pHead; pCur != nullptr; pPrev = pCur, pCur = pCur->getNextInBucket())
+	{
+		if (pCur != pTask)
+			continue;
+
+		if (pPrev != nullptr)
+			pPrev->setNextInBucket(pTask->getNextInBucket());
+		else
+			pHead = pTask->getNextInBucket();
+
+		pTask->setNextInBucket(nullptr);
+		m_iIndexed--;
+		return;
+	}
+}
+
+void CTaskMngr::indexGrow(void)
+{
+	const size_t iNewSize = m_Buckets.empty() ? 64u : m_Buckets.length() * 2u;
+	ke::Vector<CTask*> buckets;
+	if (!buckets.resize(iNewSize))
+		return;
+
+	size_t i;
+	CTask *pTask, *pNext;
+	for (i = 0u; i < m_Buckets.length(); i++)
+	{
+		for (pTask = m_Buckets[i]; pTask != nullptr; pTask = pNext)
+		{
+			pNext = pTask->getNextInBucket();
+
+			CTask *&pHead = buckets[HashTaskKey(pTask->getAMX(), pTask->getTaskId()) & (iNewSize - 1u)];
+			pTask->setNextInBucket(pHead);
+			pHead = pTask;
+		}
+	}
+
+	m_Buckets = ke::Move(buckets);
+}
+
+void CTaskMngr::heapPush(CTask *pTask)
+{
+	pTask->setHeapIndex(static_cast<int>(m_Heap.length()));
+	m_Heap.append(pTask);
+	heapSiftUp(m_Heap.length() - 1);
+}
+
+void CTaskMngr::heapRemove(CTask *pTask)
+{
+	const int iIndex = pTask->getHeapIndex();
+	if (iIndex == -1)
+		return;
+
+	pTask->setHeapIndex(-1);
+
+	CTask *pLast = m_Heap.popCopy();
+	if (pLast == pTask)
+		return;
+
+	m_Heap[iIndex] = pLast;
+	pLast->setHeapIndex(iIndex);
+	heapUpdate(pLast);
+}
+
+void CTaskMngr::heapUpdate(CTask *pTask)
+{
+	const int iIndex = pTask->getHeapIndex();
+	if (iIndex == -1)
+		return;
+
+	heapSiftUp(iIndex);
+	heapSiftDown(pTask->getHeapIndex());
+}
+
+void CTaskMngr::heapSiftUp(size_t iIndex)
+{
+	size_t iParent;
+	while (iIndex > 0u)
+	{
+		iParent = (iIndex - 1u) / 2u;
+		if (m_Heap[iParent]->getNextExecTime() <= m_Heap[iIndex]->getNextExecTime())
+			break;
+
+		heapSwap(iParent, iIndex);
+		iIndex = iParent;
+	}
+}
+
+void CTaskMngr::heapSiftDown(size_t iIndex)
+{
+	const size_t iSize = m_Heap.length();
+	size_t iChild, iSmallest;
+	while (true)
+	{
+		iSmallest = iIndex;
+		iChild = iIndex * 2u + 1u;
+		if (iChild < iSize && m_Heap[iChild]->getNextExecTime() < m_Heap[iSmallest]->getNextExecTime())
+			iSmallest = iChild;
+
+		iChild++;
+		if (iChild < iSize && m_Heap[iChild]->getNextExecTime() < m_Heap[iSmallest]->getNextExecTime())
+			iSmallest = iChild;
+
+		if (iSmallest == iIndex)
+			break;
+
+		heapSwap(iIndex, iSmallest);
+		iIndex = iSmallest;
+	}
+}
+
+void CTaskMngr::heapSwap(const size_t iFirst, const size_t iSecond)
+{
+	CTask *pTemp = m_Heap[iFirst];
+	m_Heap[iFirst] = m_Heap[iSecond];
+	m_Heap[iSecond] = pTemp;
+	m_Heap[iFirst]->setHeapIndex(static_cast<int>(iFirst));
+	m_Heap[iSecond]->setHeapIndex(static_cast<int>(iSecond));
+}
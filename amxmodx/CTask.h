@@ -34,6 +34,11 @@ private:
 
 		// execution
 		float m_fNextExecTime;
+
+		// scheduling (owned by CTaskMngr)
+		int m_iHeapIndex;
+		bool m_bPending;
+		CTask *m_pNextInBucket;
 	public:
 		void set(CPluginMngr::CPlugin *pPlugin, const cell iFunc, const int iFlags, cell iId, const float fBase, const int8_t iParamsLen, const cell *pParams, const int16_t iRepeat, const float fCurrentTime);
 		void clear(void);
@@ -41,7 +46,16 @@ private:
 		inline CPluginMngr::CPlugin *getPlugin(void) const { return m_pPlugin; }
 		inline AMX *getAMX(void) const { return m_pPlugin->getAMX(); }
 		inline int getTaskId(void) const { return m_iId; }
-		void executeIfRequired(const float fCurrentTime, const float fTimeLimit, const float fTimeLeft);	// also removes the task if needed
+		inline float getNextExecTime(void) const { return m_fNextExecTime; }
+		inline bool followsMapTimer(void) const { return m_bAfterStart || m_bBeforeEnd; }
+		inline int getHeapIndex(void) const { return m_iHeapIndex; }
+		inline void setHeapIndex(const int iIndex) { m_iHeapIndex = iIndex; }
+		inline bool isPending(void) const { return m_bPending; }
+		inline void setPending(const bool bPending) { m_bPending = bPending; }
+		inline CTask *getNextInBucket(void) const { return m_pNextInBucket; }
+		inline void setNextInBucket(CTask *pTask) { m_pNextInBucket = pTask; }
+		bool isDue(const float fCurrentTime, const float fTimeLimit, const float fTimeLeft) const;
+		bool execute(void);	// returns false once the task is done and should be removed
 		void changeBase(const float fNewBase);
 		void resetNextExecTime(const float fCurrentTime);
 		inline bool inExecute(void) const { return m_bInExecute; }
@@ -56,10 +70,32 @@ private:
 	};
 
 	/*** CTaskMngr priv members ***/
-	ke::Vector<ke::AutoPtr<CTask>> m_Tasks;
+	ke::Vector<ke::AutoPtr<CTask>> m_Tasks;	// owns every task slot, free or not
+	ke::Vector<CTask*> m_FreeTasks;			// slots that can be reused by registerTask
+	ke::Vector<CTask*> m_Heap;				// min-heap of interval tasks keyed on the next exec time
+	ke::Vector<CTask*> m_MapTimerTasks;		// "c" / "d" tasks, they depend on the map timer instead
+	ke::Vector<CTask*> m_DueTasks;			// tasks picked up by the current frame
+	ke::Vector<CTask*> m_Buckets;			// (amx, id) index, chained through CTask::m_pNextInBucket
+	size_t m_iIndexed;
+	ke::Vector<int> m_PluginTaskCounts;		// live tasks per plugin id
 	float *m_pTmr_CurrentTime;
 	float *m_pTmr_TimeLimit;
 	float *m_pTmr_TimeLeft;
+
+	void schedule(CTask *pTask);
+	void unschedule(CTask *pTask);
+	void releaseTask(CTask *pTask);
+	void forgetTask(CTask *pTask);
+	void indexAdd(CTask *pTask);
+	void indexRemove(CTask *pTask);
+	void indexGrow(void);
+	CTask *indexFirst(AMX *pAmx, const cell iId) const;
+	void heapPush(CTask *pTask);
+	void heapRemove(CTask *pTask);
+	void heapUpdate(CTask *pTask);
+	void heapSiftUp(size_t iIndex);
+	void heapSiftDown(size_t iIndex);
+	void heapSwap(const size_t iFirst, const size_t iSecond);
 public:
 	CTaskMngr(void);
 	~CTaskMngr(void);
@@ -68,6 +104,7 @@ public:
 	int removeTasks(const int iId, AMX *pAmx);											// remove all tasks that match the id and amx
 	int changeTasks(const int iId, AMX *pAmx, const float fNewBase);							// change all tasks that match the id and amx
 	bool taskExists(const int iId, AMX *pAmx);
+	int getTaskCount(CPluginMngr::CPlugin *pPlugin) const;							// live tasks owned by the plugin
 	void startFrame(void);
 	void clear(void);
 };
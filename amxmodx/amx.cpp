@@ -472,7 +472,10 @@ int AMXAPI amx_Callback(AMX *amx, cell index, cell *result, cell *params)
   }
 #endif //BINLOG_ENABLED
 
-  *result = f(amx,params);
+  if (g_profiler.IsActive())
+    *result = g_profiler.CallNative(amx, index, f, params);
+  else
+    *result = f(amx,params);
 
 #if defined BINLOG_ENABLED
   if (logfuncs)
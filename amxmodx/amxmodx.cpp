@@ -254,6 +254,153 @@ static cell AMX_NATIVE_CALL console_print(AMX *amx, cell *params) /* 2 param */
 	return 0;
 }
 
+// Messages sent to all players (index 0) used to be formatted again for every
+// recipient. The text only depends on the recipient through LANG_PLAYER, so it
+// is formatted once per language in use and the others reuse it. When every
+// recipient ends up with the same bytes a single message is sent to all.
+#define BROADCAST_TEXT_LENGTH 4100 // format buffer plus what natives append
+
+struct BroadcastText
+{
+	char lang[32];
+	char text[BROADCAST_TEXT_LENGTH];
+	int len;
+};
+
+struct BroadcastRecipient
+{
+	CPlayer *player;
+	BroadcastText *text;
+	int channel;
+};
+
+class Broadcast
+{
+public:
+	// A player that is not sent the message. Nothing can be sent to all if it
+	// would reach this player too.
+	void Skip(CPlayer *pPlayer);
+
+	// Adds the player as recipient and gives the text meant for that player. Returns true
+	// when the text has just been formatted and still needs the native's own fixups.
+	bool Format(AMX *amx, cell *params, int parm, int index, BroadcastText *&text);
+
+	// The text every recipient got, if it was the same for all (whatever their
+	// language) and nobody else would get a message sent to all.
+	BroadcastText *Shared();
+
+	// What the native returns, the length of the last text sent
+	inline int LastLength() const { return m_Count ? m_To[m_Count - 1].text->len : 0; }
+
+	inline int Count() const { return m_Count; }
+	inline BroadcastRecipient &Recipient(int index) { return m_To[index]; }
+
+private:
+	friend class BroadcastScope;
+	void Reset();
+
+	BroadcastText m_Texts[33];
+	BroadcastRecipient m_To[33];
+	int m_TextCount;
+	int m_Count;
+	bool m_Missing;
+};
+
+// Sending ends with MESSAGE_END, which runs message hooks and events, and those
+// may broadcast again while the outer native is still going through its
+// recipients. Each nesting level works on its own tables.
+static ke::Vector<ke::AutoPtr<Broadcast>> BroadcastLevels;
+static size_t BroadcastDepth;
+
+class BroadcastScope
+{
+public:
+	BroadcastScope()
+	{
+		if (BroadcastDepth == BroadcastLevels.length())
+			BroadcastLevels.append(ke::AutoPtr<Broadcast>(new Broadcast));
+
+		m_Broadcast = BroadcastLevels[BroadcastDepth++].get();
+		m_Broadcast->Reset();
+	}
+
+	~BroadcastScope()
+	{
+		--BroadcastDepth;
+	}
+
+	inline Broadcast *operator ->() { return m_Broadcast; }
+
+private:
+	Broadcast *m_Broadcast;
+};
+
+void Broadcast::Reset()
+{
+	m_TextCount = 0;
+	m_Count = 0;
+	m_Missing = false;
+}
+
+void Broadcast::Skip(CPlayer *pPlayer)
+{
+	if (pPlayer->initialized && !pPlayer->IsBot())
+		m_Missing = true;
+}
+
+bool Broadcast::Format(AMX *amx, cell *params, int parm, int index, BroadcastText *&text)
+{
+	BroadcastRecipient &recipient = m_To[m_Count++];
+	recipient.player = GET_PLAYER_POINTER_I(index);
+	recipient.channel = -1;
+
+	g_langMngr.SetDefLang(index);
+
+	// same fallback as %L, no or a bogus "lang" setinfo means the server language
+	const char *lang = playerlang(LANG_PLAYER);
+	if (lang && !isalpha(lang[0]))
+		lang = amxmodx_language->string;
+
+	// too long to be a real language, don't risk mixing it with another one
+	const bool shareable = lang && *lang != '\0' && cstrlen(lang) < static_cast<int>(sizeof(text->lang));
+
+	int i;
+	for (i = 0; shareable && i < m_TextCount; ++i)
+	{
+		if (m_Texts[i].lang[0] != '\0' && !cstrcmp(m_Texts[i].lang, lang))
+		{
+			text = recipient.text = &m_Texts[i];
+			return false;
+		}
+	}
+
+	text = recipient.text = &m_Texts[m_TextCount++];
+	if (shareable)
+		cstrcpy(text->lang, lang);
+	else
+		text->lang[0] = '\0';
+
+	const char *msg = format_amxstring(amx, params, parm, text->len);
+	cmemcpy(text->text, msg, text->len + 1);
+	return true;
+}
+
+BroadcastText *Broadcast::Shared()
+{
+	if (m_Missing || !m_Count)
+		return nullptr;
+
+	// Languages that came out as the same bytes share the message. Compared here
+	// rather than in Format, as the natives fix each text up after formatting.
+	for (int i = 1; i < m_TextCount; ++i)
+	{
+		if (m_Texts[i].len != m_Texts[0].len || cstrcmp(m_Texts[i].text, m_Texts[0].text))
+			return nullptr;
+	}
+
+	return &m_Texts[0];
+}
+
 // print_notify and print_console are limited to 127 bytes, including the newline.
 // print_chat and print_center are not limited by *this* function.
 static cell AMX_NATIVE_CALL client_print(AMX *amx, cell *params) /* 3 param */
@@ -265,48 +412,67 @@ static cell AMX_NATIVE_CALL client_print(AMX *amx, cell *params) /* 3 param */
 		char* msg;
 		int j, bytesLimit;
 		CPlayer* pPlayer;
+		BroadcastText* text;
 		int8_t i;
 		const int8_t max = static_cast<int8_t>(gpGlobals->maxClients);
+
+		BroadcastScope broadcast;
 		for (i = 1; i <= max; ++i)
 		{
 			pPlayer = GET_PLAYER_POINTER_I(i);
-			if (pPlayer->ingame && !pPlayer->IsBot())
+			if (!pPlayer->ingame || pPlayer->IsBot())
 			{
-				g_langMngr.SetDefLang(i);
-				msg = format_amxstring(amx, params, 3, len);
+				broadcast->Skip(pPlayer);
+				continue;
+			}
 
-				// Client console truncates after byte 127.
-				// If format string is used, limit includes double new lines (125 + \n\n), otherwise one new line (126 + \n).
-				bytesLimit = canUseFormatString ? 125 : 126;
+			if (!broadcast->Format(amx, params, 3, i, text))
+				continue;
 
-				if (g_bmod_cstrike && params[2] == HUD_PRINTCENTER) // Likely a temporary fix.
-				{
-					for (j = 0; j < len; ++j)
-					{
-						if (msg[j] == '\n')
-							msg[j] = '\r';
-					}
-				}
-				else if (((params[2] == HUD_PRINTNOTIFY) || (params[2] == HUD_PRINTCONSOLE)) && (len > bytesLimit))	
-				{
-					len = bytesLimit;
-					if ((msg[len - 1] & 1 << 7))
-						len -= UTIL_CheckValidChar(msg + len - 1); // Don't truncate a multi-byte character
-				}
+			msg = text->text;
+			len = text->len;
 
-				msg[len++] = '\n';
-				if (canUseFormatString)
+			// Client console truncates after byte 127.
+			// If format string is used, limit includes double new lines (125 + \n\n), otherwise one new line (126 + \n).
+			bytesLimit = canUseFormatString ? 125 : 126;
+
+			if (g_bmod_cstrike && params[2] == HUD_PRINTCENTER) // Likely a temporary fix.
+			{
+				for (j = 0; j < len; ++j)
 				{
-					if (!g_bmod_cstrike || params[2] == HUD_PRINTNOTIFY || params[2] == HUD_PRINTCONSOLE)
-						msg[len++] = '\n';  // Double newline is required when pre-formatted string in TextMsg is passed as argument.
+					if (msg[j] == '\n')
+						msg[j] = '\r';
 				}
-				
-				msg[len] = 0;
-				UTIL_ClientPrint(pPlayer->pEdict, params[2], msg);
 			}
+			else if (((params[2] == HUD_PRINTNOTIFY) || (params[2] == HUD_PRINTCONSOLE)) && (len > bytesLimit))	
+			{
+				len = bytesLimit;
+				if ((msg[len - 1] & 1 << 7))
+					len -= UTIL_CheckValidChar(msg + len - 1); // Don't truncate a multi-byte character
+			}
+
+			msg[len++] = '\n';
+			if (canUseFormatString)
+			{
+				if (!g_bmod_cstrike || params[2] == HUD_PRINTNOTIFY || params[2] == HUD_PRINTCONSOLE)
+					msg[len++] = '\n';  // Double newline is required when pre-formatted string in TextMsg is passed as argument.
+			}
+			
+			msg[len] = 0;
+			text->len = len;
 		}
 
-		return len;
+		if ((text = broadcast->Shared()) != nullptr)
+		{
+			UTIL_ClientPrint(nullptr, params[2], text->text);
+		}
+		else
+		{
+			for (j = 0; j < broadcast->Count(); ++j)
+				UTIL_ClientPrint(broadcast->Recipient(j).player->pEdict, params[2], broadcast->Recipient(j).text->text);
+		}
+
+		return broadcast->LastLength();
 	}
 	else // A specific player
 	{
@@ -382,34 +548,57 @@ static cell AMX_NATIVE_CALL client_print_color(AMX* amx, cell* params) /* 3 para
 		int len = 0;
 		char* msg;
 		CPlayer* pPlayer;
+		BroadcastText* text;
 		const int8_t max = static_cast<int8_t>(gpGlobals->maxClients);
+
+		BroadcastScope broadcast;
 		for (i = static_cast<int8_t>(1); i <= max; ++i)
 		{
 			pPlayer = GET_PLAYER_POINTER_I(i);
-			if (pPlayer->ingame && !pPlayer->IsBot())
+			if (!pPlayer->ingame || pPlayer->IsBot())
 			{
-				g_langMngr.SetDefLang(i);
-				msg = format_amxstring(amx, params, 3, len);
+				broadcast->Skip(pPlayer);
+				continue;
+			}
 
-				if (static_cast<byte>(*msg) > 4) // Insert default color code at the start if not present, otherwise message will not be colored.
-				{
-					cmemmove(msg + 1, msg, cmin(len++, 191));
-					*msg = 1;
-				}
+			if (!broadcast->Format(amx, params, 3, i, text))
+				continue;
 
-				if (len > 187)	// Max available bytes: 188
-				{
-					len = 187;
-					if ((msg[len - 1] & 1 << 7))
-						len -= UTIL_CheckValidChar(msg + len - 1); // Don't truncate a multi-byte character
-				}
-				
-				msg[len] = 0;
-				UTIL_ClientSayText(pPlayer->pEdict, sender ? sender : i, msg);
+			msg = text->text;
+			len = text->len;
+
+			if (static_cast<byte>(*msg) > 4) // Insert default color code at the start if not present, otherwise message will not be colored.
+			{
+				cmemmove(msg + 1, msg, cmin(len++, 191));
+				*msg = 1;
+			}
+
+			if (len > 187)	// Max available bytes: 188
+			{
+				len = 187;
+				if ((msg[len - 1] & 1 << 7))
+					len -= UTIL_CheckValidChar(msg + len - 1); // Don't truncate a multi-byte character
 			}
+			
+			msg[len] = 0;
+			text->len = len;
 		}
 
-		return len;
+		// Without a sender every player is the sender of its own message, they differ.
+		if (sender && (text = broadcast->Shared()) != nullptr)
+		{
+			UTIL_ClientSayText(nullptr, sender, text->text);
+		}
+		else
+		{
+			for (i = 0; i < broadcast->Count(); ++i)
+			{
+				pPlayer = broadcast->Recipient(i).player;
+				UTIL_ClientSayText(pPlayer->pEdict, sender ? sender : pPlayer->index, broadcast->Recipient(i).text->text);
+			}
+		}
+
+		return broadcast->LastLength();
 	}
 	else
 	{
@@ -572,31 +761,58 @@ static cell AMX_NATIVE_CALL show_hudmessage(AMX *amx, cell *params) /* 2 param *
 		else
 			aut = false;
 
-		uint_fast8_t channel;
-		int len;
+		uint_fast8_t channel = static_cast<uint_fast8_t>(g_hudset.channel);
+		bool sameChannel = true;
 		CPlayer* pPlayer;
+		BroadcastText* text;
 		int8_t i;
 		const int8_t max = static_cast<int8_t>(gpGlobals->maxClients);
+
+		BroadcastScope broadcast;
 		for (i = 1; i <= max; ++i)
 		{
 			pPlayer = GET_PLAYER_POINTER_I(i);
-			if (pPlayer->ingame && !pPlayer->IsBot())
+			if (!pPlayer->ingame || pPlayer->IsBot())
 			{
-				g_langMngr.SetDefLang(i);
-				if (aut)
-				{
-					channel = pPlayer->NextHUDChannel();
-					pPlayer->channels[channel] = gpGlobals->time;
-					g_hudset.channel = static_cast<int>(channel);
-				}
+				broadcast->Skip(pPlayer);
+				continue;
+			}
+
+			if (aut)
+			{
+				channel = pPlayer->NextHUDChannel();
+				pPlayer->channels[channel] = gpGlobals->time;
+			}
+
+			// don't need to set g_hudset!
+			pPlayer->hudmap[channel] = 0;
 
-				// don't need to set g_hudset!
-				pPlayer->hudmap[channel] = 0;
-				UTIL_HudMessage(pPlayer->pEdict, g_hudset, UTIL_SplitHudMessage(format_amxstring(amx, params, 2, len)));
+			if (broadcast->Format(amx, params, 2, i, text))
+			{
+				const char *split = UTIL_SplitHudMessage(text->text);
+				cmemcpy(text->text, split, cstrlen(split) + 1);
 			}
+
+			broadcast->Recipient(broadcast->Count() - 1).channel = channel;
+			if (broadcast->Recipient(0).channel != static_cast<int>(channel))
+				sameChannel = false;
 		}
 
-		return len;
+		if (sameChannel && (text = broadcast->Shared()) != nullptr)
+		{
+			g_hudset.channel = broadcast->Recipient(0).channel;
+			UTIL_HudMessage(nullptr, g_hudset, text->text);
+		}
+		else
+		{
+			for (i = 0; i < broadcast->Count(); ++i)
+			{
+				g_hudset.channel = broadcast->Recipient(i).channel;
+				UTIL_HudMessage(broadcast->Recipient(i).player->pEdict, g_hudset, broadcast->Recipient(i).text->text);
+			}
+		}
+
+		return broadcast->LastLength();
 	}
 	else
 	{
@@ -655,32 +871,51 @@ static cell AMX_NATIVE_CALL show_dhudmessage(AMX *amx, cell *params) /* 2 param
 		int len = 0;
 		char* message;
 		CPlayer* pPlayer;
+		BroadcastText* text;
 		int8_t i;
 		const int8_t max = static_cast<int8_t>(gpGlobals->maxClients);
+
+		BroadcastScope broadcast;
 		for (i = 1; i <= max; ++i)
 		{
 			pPlayer = GET_PLAYER_POINTER_I(i);
-			if (pPlayer->ingame && !pPlayer->IsBot())
+			if (!pPlayer->ingame || pPlayer->IsBot())
 			{
-				g_langMngr.SetDefLang(i);
-				message = format_amxstring(amx, params, 2, len);
+				broadcast->Skip(pPlayer);
+				continue;
+			}
 
-				if (len > 127) // client truncates after byte 127
-				{
-					len = 127;
+			if (!broadcast->Format(amx, params, 2, i, text))
+				continue;
 
-					// don't truncate a double-byte character
-					if (((message[len - 1] & 0xFF) >= 0xC2) && ((message[len - 1] & 0xFF) <= 0xEF))
-						len--;
+			message = text->text;
+			len = text->len;
 
-					message[len] = 0;
-				}
+			if (len > 127) // client truncates after byte 127
+			{
+				len = 127;
+
+				// don't truncate a double-byte character
+				if (((message[len - 1] & 0xFF) >= 0xC2) && ((message[len - 1] & 0xFF) <= 0xEF))
+					len--;
 
-				UTIL_DHudMessage(pPlayer->pEdict, g_hudset, message, len);
+				message[len] = 0;
 			}
+
+			text->len = len;
 		}
 
-		return len;
+		if ((text = broadcast->Shared()) != nullptr)
+		{
+			UTIL_DHudMessage(nullptr, g_hudset, text->text, text->len);
+		}
+		else
+		{
+			for (i = 0; i < broadcast->Count(); ++i)
+				UTIL_DHudMessage(broadcast->Recipient(i).player->pEdict, g_hudset, broadcast->Recipient(i).text->text, broadcast->Recipient(i).text->len);
+		}
+
+		return broadcast->LastLength();
 	}
 	else
 	{
@@ -3033,8 +3268,9 @@ static cell AMX_NATIVE_CALL read_logargc(AMX *amx, cell *params)
 
 static cell AMX_NATIVE_CALL read_logargv(AMX *amx, cell *params)
 {
-	const char *value = g_logevents.getLogArg(params[1]);
-	return set_amxstring_utf8(amx, params[2], value, cstrlen(value), params[3]);
+	int length;
+	const char *value = g_logevents.getLogArg(params[1], length);
+	return set_amxstring_utf8(amx, params[2], value, length, params[3]);
 }
 
 static cell AMX_NATIVE_CALL parse_loguser(AMX *amx, cell *params)
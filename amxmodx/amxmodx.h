@@ -43,6 +43,7 @@
 #include "CTask.h"
 #include "CLogEvent.h"
 #include "CForward.h"
+#include "CProfiler.h"
 #include "CCmd.h"
 #include "CEvent.h"
 #include "CLang.h"
@@ -184,6 +185,7 @@ extern ke::AString g_mod_name;
 extern TeamIds g_teamsIds;
 extern Vault g_vault;
 extern CForwardMngr g_forwards;
+extern CProfiler g_profiler;
 extern WeaponsVault g_weaponsData[MAX_WEAPONS];
 extern XVars g_xvars;
 extern bool g_bmod_cstrike;
@@ -53,6 +53,7 @@ CAmxxReader::CAmxxReader(const char *filename, const int cellsize)
 {
 	m_Bh.plugins = nullptr;
 	m_AmxxFile = false;
+	m_Quiet = false;
 	
 	if (!filename)
 	{
@@ -326,7 +327,8 @@ CAmxxReader::Error CAmxxReader::GetSection(void *buffer)
 		char* tempBuffer = new(std::nothrow) char[m_SectionLength + 1];
 		if (tempBuffer == nullptr)
 		{
-			AMXXLOG_Log("[AMXX] Memory Error, Low/Damaged Memory");
+			if (!m_Quiet)
+				AMXXLOG_Log("[AMXX] Memory Error, Low/Damaged Memory");
 			m_Status = Err_Decompress;
 			return Err_Memory;
 		}
@@ -340,7 +342,8 @@ CAmxxReader::Error CAmxxReader::GetSection(void *buffer)
 		
 		if (result != Z_OK)
 		{
-			AMXXLOG_Log("[AMXX] Zlib error encountered: %d(%d)", result, m_SectionLength);
+			if (!m_Quiet)
+				AMXXLOG_Log("[AMXX] Zlib error encountered: %d(%d)", result, m_SectionLength);
 			m_Status = Err_Decompress;
 			return Err_Decompress;
 		}
@@ -352,7 +355,8 @@ CAmxxReader::Error CAmxxReader::GetSection(void *buffer)
 		char* tempBuffer = new(std::nothrow) char[m_SectionLength + 1];
 		if (tempBuffer == nullptr)
 		{
-			AMXXLOG_Log("[AMXX] Memory Error, Low/Damaged Memory");
+			if (!m_Quiet)
+				AMXXLOG_Log("[AMXX] Memory Error, Low/Damaged Memory");
 			m_Status = Err_Decompress;
 			return Err_Memory;
 		}
@@ -372,7 +376,8 @@ CAmxxReader::Error CAmxxReader::GetSection(void *buffer)
 		
 		if (result != Z_OK)
 		{
-			AMXXLOG_Log("[AMXX] Zlib error encountered: %d(%d)", result, m_SectionLength);
+			if (!m_Quiet)
+				AMXXLOG_Log("[AMXX] Zlib error encountered: %d(%d)", result, m_SectionLength);
 			m_Status = Err_Decompress;
 			return Err_Decompress;
 		}
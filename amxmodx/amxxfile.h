@@ -61,6 +61,7 @@ private:
 	int m_CellSize;
 	int m_SectionHdrOffset; // offset to the table in the header that describes the required section
 	int m_SectionLength;
+	bool m_Quiet; // don't log errors, the reader is used off the main thread
 public:
 	CAmxxReader(const char *filename, const int cellsize);
 	~CAmxxReader(void);
@@ -68,6 +69,7 @@ public:
 	size_t GetBufferSize(void); // get the size for the buffer
 	Error GetSection(void *buffer); // copy the currently selected section to the buffer
 	inline bool IsOldFile(void) const { return m_OldFile; }
+	inline void SetQuiet(bool quiet) { m_Quiet = quiet; }
 };
 
 #endif // __AMXXFILE_H__
@@ -22,6 +22,36 @@
 
 #include <stdarg.h>
 
+// String kernels use SSE2 when the compiler targets it, 16 bytes per step.
+// Loads may read past the terminator but never cross into the next page:
+// either they are aligned or the pointer is checked against the page end.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CLIB_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define CLIB_PAGE_SAFE(ptr) ((reinterpret_cast<uintptr_t>(ptr) & 4095) <= 4096 - 16)
+
+// index of the lowest set bit, mask must not be 0
+inline int cbitscan(const unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+inline unsigned int cmask16(const __m128i value)
+{
+	return static_cast<unsigned int>(_mm_movemask_epi8(value));
+}
+#endif
+
 inline int crandomint(const int min, const int max)
 {
 	if (min > max)
@@ -252,15 +282,63 @@ inline double cround(const double value)
 
 inline int cstrlen(const char* str)
 {
+#ifdef CLIB_SSE2
+	// start from the aligned block holding str, ignoring the bytes before it
+	const int offset = static_cast<int>(reinterpret_cast<uintptr_t>(str) & 15);
+	const char* block = str - offset;
+	const __m128i zero = _mm_setzero_si128();
+
+	unsigned int mask = cmask16(_mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(block)), zero)) >> offset;
+	if (mask)
+		return cbitscan(mask);
+
+	while (true)
+	{
+		block += 16;
+		mask = cmask16(_mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(block)), zero));
+		if (mask)
+			return static_cast<int>(block - str) + cbitscan(mask);
+	}
+#else
 	int cache = 0;
 	while (str[cache] != '\0')
 		cache++;
 	return cache;
+#endif
 }
 
 inline int cstrcmp(const char* str1, const char* str2)
 {
 	int t1, t2;
+#ifdef CLIB_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	__m128i a, b;
+	unsigned int mask;
+
+	// whole blocks while both sides are far enough from a page end,
+	// the byte loop below takes over for the rest
+	while (CLIB_PAGE_SAFE(str1) && CLIB_PAGE_SAFE(str2))
+	{
+		a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str1));
+		b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str2));
+
+		// first byte that differs or ends the strings
+		mask = (cmask16(_mm_cmpeq_epi8(a, b)) ^ 0xFFFF) | cmask16(_mm_cmpeq_epi8(a, zero));
+		if (mask)
+		{
+			t1 = str1[cbitscan(mask)];
+			t2 = str2[cbitscan(mask)];
+
+			if (t1 == t2)
+				return 0;
+
+			return (t1 > t2) ? 1 : -1;
+		}
+
+		str1 += 16;
+		str2 += 16;
+	}
+#endif
 	do
 	{
 		t1 = *str1;
@@ -285,10 +363,46 @@ inline int cstrcmp(const char* str1, const char* str2)
 	return -1;
 }
 
+// FNV-1a
+inline uint32_t cstrhash(const char* str)
+{
+	uint32_t hash = 2166136261u;
+	while (*str != '\0')
+	{
+		hash ^= static_cast<unsigned char>(*str);
+		hash *= 16777619u;
+		str++;
+	}
+
+	return hash;
+}
+
 inline int cstrncmp(const char* str1, const char* str2, const int num)
 {
-	int cache;
-	for (cache = 0; cache < num; ++cache)
+	int cache = 0;
+#ifdef CLIB_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	__m128i a, b;
+	unsigned int mask;
+
+	for (; cache + 16 <= num && CLIB_PAGE_SAFE(str1 + cache) && CLIB_PAGE_SAFE(str2 + cache); cache += 16)
+	{
+		a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str1 + cache));
+		b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str2 + cache));
+
+		mask = (cmask16(_mm_cmpeq_epi8(a, b)) ^ 0xFFFF) | cmask16(_mm_cmpeq_epi8(a, zero));
+		if (mask)
+		{
+			cache += cbitscan(mask);
+
+			if (str1[cache] == str2[cache])
+				return 0;
+
+			return (str1[cache] < str2[cache]) ? -1 : 1;
+		}
+	}
+#endif
+	for (; cache < num; ++cache)
 	{
 		if (str1[cache] != str2[cache])
 			return (str1[cache] < str2[cache]) ? -1 : 1;
@@ -299,8 +413,13 @@ inline int cstrncmp(const char* str1, const char* str2, const int num)
 	return 0;
 }
 
+inline void cmemcpy(void* dest, const void* src, const int size);
+
 inline void cstrcpy(char* dest, const char* src)
 {
+#ifdef CLIB_SSE2
+	cmemcpy(dest, src, cstrlen(src) + 1);
+#else
 	while (*src != '\0')
 	{
 		*dest = *src;
@@ -309,6 +428,7 @@ inline void cstrcpy(char* dest, const char* src)
 	}
 
 	*dest = '\0';
+#endif
 }
 
 inline void cstrncpy(char* dest, const char* src, const int count)
@@ -331,8 +451,12 @@ inline void cmemcpy(void* dest, const void* src, const int size)
 	char* dest2 = static_cast<char*>(dest);
 	const char* src2 = static_cast<const char*>(src);
 
-	int cache;
-	for (cache = 0; cache < size; cache++)
+	int cache = 0;
+#ifdef CLIB_SSE2
+	for (; cache + 16 <= size; cache += 16)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest2 + cache), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src2 + cache)));
+#endif
+	for (; cache < size; cache++)
 		dest2[cache] = src2[cache];
 }
 
@@ -341,8 +465,13 @@ inline void cmemset(void* dest, const int value, const int count)
 	unsigned char* ptr = static_cast<unsigned char*>(dest);
 	const unsigned char byteValue = static_cast<unsigned char>(value);
 
-	int cache;
-	for (cache = 0; cache < count; cache++)
+	int cache = 0;
+#ifdef CLIB_SSE2
+	const __m128i fill = _mm_set1_epi8(static_cast<char>(byteValue));
+	for (; cache + 16 <= count; cache += 16, ptr += 16)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), fill);
+#endif
+	for (; cache < count; cache++)
 	{
 		*ptr = byteValue;
 		ptr++;
@@ -466,6 +595,53 @@ inline char* cstrstr(char* str1, char* str2)
 {
 	char* p1;
 	char* p2;
+#ifdef CLIB_SSE2
+	if (*str2 != '\0')
+	{
+		// look for the first needle char a block at a time, then check the rest
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i first = _mm_set1_epi8(*str2);
+		const int offset = static_cast<int>(reinterpret_cast<uintptr_t>(str1) & 15);
+		char* block = str1 - offset;
+		unsigned int skip = ~0u << offset;
+		unsigned int zeros, matches;
+		__m128i data;
+
+		while (true)
+		{
+			data = _mm_load_si128(reinterpret_cast<const __m128i*>(block));
+			zeros = cmask16(_mm_cmpeq_epi8(data, zero)) & skip;
+			matches = cmask16(_mm_cmpeq_epi8(data, first)) & skip;
+
+			// only candidates before the end of the string
+			if (zeros)
+				matches &= (zeros & (0u - zeros)) - 1;
+
+			while (matches)
+			{
+				p1 = block + cbitscan(matches) + 1;
+				p2 = str2 + 1;
+
+				while (*p2 != '\0' && *p1 == *p2)
+				{
+					p1++;
+					p2++;
+				}
+
+				if (*p2 == '\0')
+					return block + cbitscan(matches);
+
+				matches &= matches - 1;
+			}
+
+			if (zeros)
+				return nullptr;
+
+			block += 16;
+			skip = ~0u;
+		}
+	}
+#endif
 	while (*str1 != '\0')
 	{
 		p1 = str1;
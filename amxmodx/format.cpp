@@ -77,14 +77,48 @@ const char *playerlang(const cell index)
 	return pLangName;
 }
 
-const char *translate(AMX *amx, const char *lang, const char *key)
+// Same as playerlang() but also gives the id of the language, -1 if it isn't loaded.
+// Returns false when the index doesn't stand for a language.
+// Players remember the id of their "lang" setinfo until it or the dictionaries change.
+static bool playerlangid(const cell index, int &langId, const char *&langName)
 {
-	const char* pLangName = lang;
-	if (!pLangName || !isalpha(pLangName[0]))
-		pLangName = amxmodx_language->string;
+	langName = playerlang(index);
+	if (!langName)
+		return false;
+
+	if (!isalpha(langName[0]) || langName == amxmodx_language->string)
+	{
+		langName = amxmodx_language->string;
+		langId = g_langMngr.GetLangId(langName);
+		return true;
+	}
+
+	CPlayer *pPlayer = GET_PLAYER_POINTER_I(index == LANG_PLAYER ? g_langMngr.GetDefLang() : index);
+	const int version = g_langMngr.GetLangsVersion();
+
+	if (pPlayer->langVersion != version || cstrcmp(pPlayer->lang, langName) != 0)
+	{
+		langId = g_langMngr.GetLangId(langName);
+
+		if (cstrlen(langName) >= static_cast<int>(sizeof(pPlayer->lang)))
+			return true;
+
+		cstrcpy(pPlayer->lang, langName);
+		pPlayer->langId = langId;
+		pPlayer->langVersion = version;
+		return true;
+	}
+
+	langId = pPlayer->langId;
+	return true;
+}
+
+static const char *translate(AMX *amx, const int langId, const char *pLangName, const char *key)
+{
+	const int keyId = g_langMngr.GetKeyEntry(key);
 
 	int status;
-	const char* def = g_langMngr.GetDef(pLangName, key, status);
+	const char* def = g_langMngr.GetDef(langId, keyId, status);
 
 	if (!amx_mldebug)
 		amx_mldebug = CVAR_GET_POINTER("amx_mldebug");
@@ -121,15 +155,24 @@ const char *translate(AMX *amx, const char *lang, const char *key)
 		}
 
 		if (cstrcmp(pLangName, amxmodx_language->string) != 0)
-			def = g_langMngr.GetDef(amxmodx_language->string, key, status);
+			def = g_langMngr.GetDef(g_langMngr.GetLangId(amxmodx_language->string), keyId, status);
 
 		if (!def && (cstrcmp(pLangName, "en") != 0 && cstrcmp(amxmodx_language->string, "en") != 0))
-			def = g_langMngr.GetDef("en", key, status);
+			def = g_langMngr.GetDef(g_langMngr.GetLangId("en"), keyId, status);
 	}
 
 	return def;
 }
 
+const char *translate(AMX *amx, const char *lang, const char *key)
+{
+	const char* pLangName = lang;
+	if (!pLangName || !isalpha(pLangName[0]))
+		pLangName = amxmodx_language->string;
+
+	return translate(amx, g_langMngr.GetLangId(pLangName), pLangName, key);
+}
+
 template <typename U, typename S>
 void AddString(U **buf_p, size_t &maxlen, const S *string, int width, int prec)
 {
@@ -511,6 +554,10 @@ size_t atcprintf(D *buffer, const size_t maxlen, const S *format, AMX *amx, cell
 	const S	*fmt;
 	size_t llen = maxlen;
 
+	// %L mostly comes with the same language over and over, resolve it once per call
+	cell langIndex = LANG_SERVER;
+	int langIndexId = -1;
+
 	buf_p = buffer;
 	arg = *param;
 	fmt = format;
@@ -657,23 +704,45 @@ reswitch:
 		case 'l':
 		{
 			const char* lang;
+			int langId;
 			int len;
+			cell index, currParam = 0;
 			if (ch == 'L')
 			{
 				CHECK_ARGS(1);
-				auto currParam = params[arg++];
-				lang = playerlang(*get_amxaddr(amx, currParam));
-				if (!lang)
-					lang = get_amxstring(amx, currParam, 2, len);
+				currParam = params[arg++];
+				index = *get_amxaddr(amx, currParam);
 			}
 			else
 			{
 				CHECK_ARGS(0);
-				lang = playerlang(g_langMngr.GetDefLang());
+				index = g_langMngr.GetDefLang();
+			}
+
+			if (langIndexId != -1 && index == langIndex)
+			{
+				langId = langIndexId;
+				lang = g_langMngr.GetLangName(langId);
+			}
+			else if (playerlangid(index, langId, lang))
+			{
+				if (langId != -1)
+				{
+					langIndex = index;
+					langIndexId = langId;
+				}
+			}
+			else
+			{
+				lang = (ch == 'L') ? get_amxstring(amx, currParam, 2, len) : nullptr;
+				if (!lang || !isalpha(lang[0]))
+					lang = amxmodx_language->string;
+
+				langId = g_langMngr.GetLangId(lang);
 			}
 
 			const char* key = get_amxstring(amx, params[arg++], 3, len);
-			const char* def = translate(amx, lang, key);
+			const char* def = translate(amx, langId, lang, key);
 			if (!def)
 			{
 				static char buf[255];
@@ -67,6 +67,7 @@ extern ke::Vector<CAdminData *> DynamicAdmins;
 
 CLog g_log;
 CForwardMngr g_forwards;
+CProfiler g_profiler;
 ke::Vector<ke::AutoPtr<CPlayer *>> g_auth;
 ke::Vector<ke::AutoPtr<ForceObject>> g_forcemodels;
 ke::Vector<ke::AutoPtr<ForceObject>> g_forcesounds;
@@ -444,6 +445,7 @@ int	C_Spawn(edict_t *pent)
 		configs_dir,
 		STRING(gpGlobals->mapname));
 	g_plugins.CALMFromFile(map_pluginsfile_path);
+	g_plugins.CALMPending();
 
 	int loaded = countModules(CountModules_Running); // Call after attachModules so all modules don't have pending stat
 
@@ -742,6 +744,7 @@ void C_ServerDeactivate_Post()
 	ClearMenus();
 	g_vault.clear();
 	g_xvars.clear();
+	g_profiler.OnPluginsUnloaded();
 	g_plugins.clear();
 	g_langMngr.Clear();
 
@@ -10,6 +10,7 @@
 #include "amxmodx.h"
 #include <amxmodx_version.h>
 #include <string>
+#include <time.h>
 
 void amx_command()
 {
@@ -103,6 +104,7 @@ void amx_command()
 
 				print_srvconsole("   Filename: %s\n", plugin->getName());
 				print_srvconsole("   Status: %s\n", plugin->getStatus());
+				print_srvconsole("   Tasks: %d\n", g_tasksMngr.getTaskCount(plugin));
 			}
 			else
 			{
@@ -246,6 +248,42 @@ void amx_command()
 
 		print_srvconsole("%d modules, %d correct\n", modules, running);
 	}
+	else if (!strcmp(cmd, "prof"))
+	{
+		const char* action = (CMD_ARGC() > 2) ? CMD_ARGV(2) : "";
+		if (!strcmp(action, "start"))
+		{
+			g_profiler.Start();
+			print_srvconsole("Profiler started.\n");
+		}
+		else if (!strcmp(action, "stop"))
+		{
+			g_profiler.Stop();
+			print_srvconsole("Profiler stopped.\n");
+		}
+		else if (!strcmp(action, "clear"))
+		{
+			g_profiler.Clear();
+			print_srvconsole("Profiler data cleared.\n");
+		}
+		else if (!strcmp(action, "dump"))
+		{
+			time_t td;
+			time(&td);
+			tm* curTime = localtime(&td);
+
+			char report[PLATFORM_MAX_PATH], csv[PLATFORM_MAX_PATH];
+			build_pathname_r(report, sizeof(report), "%s/profile_%04d%02d%02d_%02d%02d%02d.log", g_log_dir.chars(), curTime->tm_year + 1900, curTime->tm_mon + 1, curTime->tm_mday, curTime->tm_hour, curTime->tm_min, curTime->tm_sec);
+			build_pathname_r(csv, sizeof(csv), "%s/profile_%04d%02d%02d_%02d%02d%02d.csv", g_log_dir.chars(), curTime->tm_year + 1900, curTime->tm_mon + 1, curTime->tm_mday, curTime->tm_hour, curTime->tm_min, curTime->tm_sec);
+
+			if (g_profiler.Dump(report, csv))
+				print_srvconsole("Profile written to \"%s\" and \"%s\".\n", report, csv);
+			else
+				print_srvconsole("Couldn't write profile to \"%s\".\n", report);
+		}
+		else
+			print_srvconsole("Usage: amxx prof < start | stop | clear | dump >\n");
+	}
 	else if (!strcmp(cmd, "gpl"))
 	{
 		print_srvconsole("AMX Mod X\n");
@@ -297,6 +335,7 @@ void amx_command()
 		print_srvconsole("   cmds [ plugin ]            - list commands registered by plugins\n");
 		print_srvconsole("   pause < plugin >           - pause a running plugin\n");
 		print_srvconsole("   unpause < plugin >         - unpause a previously paused plugin\n");
+		print_srvconsole("   prof < action >            - start, stop, clear or dump the forward and native profiler\n");
 	}
 }
 
@@ -0,0 +1,410 @@
+// vim: set ts=4 sw=4 tw=99 noet:
+//
+// AMX Mod X, based on AMX Mod by Aleksander Naszko ("OLO").
+// Copyright (C) The AMX Mod X Development Team.
+//
+// This software is licensed under the GNU General Public License, version 3 or higher.
+// Additional exceptions apply. For full license details, see LICENSE.txt or visit:
+//     https://alliedmods.net/amxmodx-license
+
+// Checks the SSE2 cstrlen/cstrcmp/cstrncmp/cstrstr from clib.h against their
+// byte by byte versions and the C library, then times the three of them.
+//
+// Strings are placed at every misalignment from 0 to 15 and against a page
+// with no access, so a block load reading past the end of a string at a page
+// boundary crashes the test.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <chrono>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <clib.h>
+
+// clib.h before the SSE2 kernels
+namespace scalar
+{
+	inline int cstrlen(const char* str)
+	{
+		int cache = 0;
+		while (str[cache] != '\0')
+			cache++;
+		return cache;
+	}
+
+	inline int cstrcmp(const char* str1, const char* str2)
+	{
+		int t1, t2;
+		do
+		{
+			t1 = *str1;
+			t2 = *str2;
+
+			if (t1 != t2)
+			{
+				if (t1 > t2)
+					return 1;
+
+				return -1;
+			}
+
+			if (!t1)
+				return 0;
+
+			str1++;
+			str2++;
+
+		} while (true);
+
+		return -1;
+	}
+
+	inline int cstrncmp(const char* str1, const char* str2, const int num)
+	{
+		int cache = 0;
+		for (; cache < num; ++cache)
+		{
+			if (str1[cache] != str2[cache])
+				return (str1[cache] < str2[cache]) ? -1 : 1;
+			else if (str1[cache] == '\0')
+				return 0;
+		}
+
+		return 0;
+	}
+
+	inline char* cstrstr(char* str1, char* str2)
+	{
+		char* p1;
+		char* p2;
+		while (*str1 != '\0')
+		{
+			p1 = str1;
+			p2 = str2;
+
+			while (*p1 != '\0' && *p2 != '\0' && *p1 == *p2)
+			{
+				p1++;
+				p2++;
+			}
+
+			if (*p2 == '\0')
+				return str1;
+
+			str1++;
+		}
+
+		return nullptr;
+	}
+}
+
+#define PAGE_SIZE	4096
+#define MAX_LENGTH	200
+
+static int Failures;
+static long Checks;
+
+static void Fail(const char *what, const char *str1, const char *str2, int value1, int value2)
+{
+	if (++Failures <= 20)
+		printf("FAIL: %s \"%s\" \"%s\": %d vs %d\n", what, str1, str2 ? str2 : "", value1, value2);
+}
+
+static int Sign(int value)
+{
+	return (value > 0) - (value < 0);
+}
+
+static bool IsAscii(const char *str)
+{
+	for (; *str; str++)
+	{
+		if (static_cast<unsigned char>(*str) >= 0x80)
+			return false;
+	}
+
+	return true;
+}
+
+// Two pages, the second one with no access
+static char *AllocGuarded()
+{
+#if defined(_WIN32)
+	char *mem = static_cast<char *>(VirtualAlloc(NULL, PAGE_SIZE * 2, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+	DWORD old;
+	VirtualProtect(mem + PAGE_SIZE, PAGE_SIZE, PAGE_NOACCESS, &old);
+#else
+	char *mem = static_cast<char *>(mmap(NULL, PAGE_SIZE * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0));
+	mprotect(mem + PAGE_SIZE, PAGE_SIZE, PROT_NONE);
+#endif
+	return mem;
+}
+
+static void FreeGuarded(char *mem)
+{
+#if defined(_WIN32)
+	VirtualFree(mem, 0, MEM_RELEASE);
+#else
+	munmap(mem, PAGE_SIZE * 2);
+#endif
+}
+
+static uint32_t Seed = 1;
+
+static uint32_t Random()
+{
+	Seed = Seed * 1664525u + 1013904223u;
+	return Seed >> 8;
+}
+
+// Small alphabet so strings share long prefixes and needles are found,
+// with a few bytes above 0x7F
+static void FillString(char *str, int length, bool high)
+{
+	for (int i = 0; i < length; i++)
+	{
+		if (high && Random() % 16 == 0)
+			str[i] = static_cast<char>(0x80 + Random() % 0x80);
+		else
+			str[i] = static_cast<char>('a' + Random() % 3);
+	}
+
+	str[length] = '\0';
+}
+
+static void CheckPair(char *str1, char *str2)
+{
+	const int length1 = static_cast<int>(strlen(str1));
+	const int length2 = static_cast<int>(strlen(str2));
+	int value, expected;
+
+	Checks++;
+
+	if ((value = cstrlen(str1)) != length1 || scalar::cstrlen(str1) != length1)
+		Fail("cstrlen", str1, NULL, value, length1);
+
+	value = cstrcmp(str1, str2);
+	expected = scalar::cstrcmp(str1, str2);
+
+	// byte order only matches the C library for ASCII, clib compares signed chars
+	if (value != expected || (IsAscii(str1) && IsAscii(str2) && value != Sign(strcmp(str1, str2))))
+		Fail("cstrcmp", str1, str2, value, expected);
+
+	for (int num = 0; num <= length1 + 2; num += 1 + num / 8)
+	{
+		value = cstrncmp(str1, str2, num);
+		expected = scalar::cstrncmp(str1, str2, num);
+
+		if (value != expected || (IsAscii(str1) && IsAscii(str2) && value != Sign(strncmp(str1, str2, num))))
+			Fail("cstrncmp", str1, str2, value, num);
+	}
+
+	// needles from the other string, so some are found and some are not
+	char needle[8];
+	for (int start = 0; start <= length2; start += 1 + start / 4)
+	{
+		const int needleLength = (length2 - start < 7) ? length2 - start : 1 + start % 7;
+		memcpy(needle, str2 + start, needleLength);
+		needle[needleLength] = '\0';
+
+		const char *found = cstrstr(str1, needle);
+		const char *foundScalar = scalar::cstrstr(str1, needle);
+		const char *foundLibc = strstr(str1, needle);
+
+		// clib never finds the empty needle in an empty string
+		if (found != foundScalar || (*str1 && found != foundLibc))
+			Fail("cstrstr", str1, needle, found ? static_cast<int>(found - str1) : -1, foundLibc ? static_cast<int>(foundLibc - str1) : -1);
+	}
+}
+
+// Every length with both strings at every misalignment
+static void TestMisalignments()
+{
+	alignas(16) static char buffer1[MAX_LENGTH + 32];
+	alignas(16) static char buffer2[MAX_LENGTH + 32];
+
+	for (int length = 0; length <= 80; length++)
+	{
+		for (int offset1 = 0; offset1 < 16; offset1++)
+		{
+			for (int offset2 = 0; offset2 < 16; offset2++)
+			{
+				char *str1 = buffer1 + offset1;
+				char *str2 = buffer2 + offset2;
+
+				FillString(str1, length, length % 4 == 3);
+
+				switch (Random() % 3)
+				{
+				case 0:
+					// equal
+					memcpy(str2, str1, length + 1);
+					break;
+				case 1:
+					// same prefix, one difference or a shorter string
+					memcpy(str2, str1, length + 1);
+					if (length)
+					{
+						const int at = Random() % length;
+						str2[at] = (Random() % 4) ? static_cast<char>('a' + Random() % 4) : '\0';
+					}
+					break;
+				default:
+					FillString(str2, Random() % (length + 16), false);
+					break;
+				}
+
+				CheckPair(str1, str2);
+			}
+		}
+	}
+}
+
+// Strings ending right before the page with no access
+static void TestPageBoundary()
+{
+	char *page1 = AllocGuarded();
+	char *page2 = AllocGuarded();
+
+	for (int length = 0; length <= 64; length++)
+	{
+		for (int shift = 0; shift < 16; shift++)
+		{
+			// the terminator is the last readable byte, at every misalignment
+			char *str1 = page1 + PAGE_SIZE - 1 - length - shift;
+			char *str2 = page2 + PAGE_SIZE - 1 - length;
+
+			FillString(str1, length + shift, false);
+			memcpy(str2, str1, length);
+			str2[length] = '\0';
+
+			// equal prefix, then one side ends
+			CheckPair(str1, str2);
+			CheckPair(str2, str1);
+
+			if (length)
+			{
+				str2[length - 1] = 'z';
+				CheckPair(str1, str2);
+				CheckPair(str2, str1);
+			}
+
+			FillString(str2, length, true);
+			CheckPair(str1, str2);
+			CheckPair(str2, str1);
+		}
+	}
+
+	// empty string as the last byte
+	page1[PAGE_SIZE - 1] = '\0';
+	page2[PAGE_SIZE - 1] = '\0';
+	CheckPair(page1 + PAGE_SIZE - 1, page2 + PAGE_SIZE - 1);
+
+	FreeGuarded(page1);
+	FreeGuarded(page2);
+}
+
+typedef std::chrono::steady_clock Clock;
+
+// Read through a volatile pointer each iteration, so calls can't be hoisted
+static char *volatile Subject;
+static char *volatile Other;
+static volatile int Sink;
+
+template <typename Func>
+static double Time(Func func)
+{
+	const int iterations = 1000000;
+
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < iterations; i++)
+	{
+		Sink += func();
+	}
+
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+}
+
+// Names, chat lines and log lines
+static void Benchmark()
+{
+	static const int lengths[] = { 12, 32, 64, 190 };
+	char needle[] = "zq";
+
+	alignas(16) static char buffer1[256];
+	alignas(16) static char buffer2[256];
+
+	printf("%-12s %12s %12s %12s  (ns per call)\n", "", "scalar", "sse2", "libc");
+
+	for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+	{
+		const int length = lengths[i];
+
+		// misaligned, equal up to the last char
+		char *str1 = buffer1 + 3;
+		char *str2 = buffer2 + 7;
+
+		for (int j = 0; j < length; j++)
+		{
+			str1[j] = str2[j] = static_cast<char>('a' + j % 26);
+		}
+
+		str1[length] = str2[length] = '\0';
+		str2[length - 1] = 'Z';
+
+		Subject = str1;
+		Other = str2;
+
+		printf("%-8s %3d %12.1f %12.1f %12.1f\n", "cstrlen", length,
+			Time([] { return scalar::cstrlen(Subject); }),
+			Time([] { return cstrlen(Subject); }),
+			Time([] { return static_cast<int>(strlen(Subject)); }));
+
+		printf("%-8s %3d %12.1f %12.1f %12.1f\n", "cstrcmp", length,
+			Time([] { return scalar::cstrcmp(Subject, Other); }),
+			Time([] { return cstrcmp(Subject, Other); }),
+			Time([] { return strcmp(Subject, Other); }));
+
+		printf("%-8s %3d %12.1f %12.1f %12.1f\n", "cstrncmp", length,
+			Time([=] { return scalar::cstrncmp(Subject, Other, length); }),
+			Time([=] { return cstrncmp(Subject, Other, length); }),
+			Time([=] { return strncmp(Subject, Other, length); }));
+
+		printf("%-8s %3d %12.1f %12.1f %12.1f\n", "cstrstr", length,
+			Time([&] { return scalar::cstrstr(Subject, needle) != nullptr; }),
+			Time([&] { return cstrstr(Subject, needle) != nullptr; }),
+			Time([] { return strstr(Subject, "zq") != nullptr; }));
+	}
+}
+
+int main()
+{
+#ifdef CLIB_SSE2
+	printf("clib.h built with SSE2\n");
+#else
+	printf("clib.h built without SSE2, checking the byte loops only\n");
+#endif
+
+	TestMisalignments();
+	TestPageBoundary();
+
+	printf("%ld string pairs checked\n", Checks);
+
+	Benchmark();
+
+	if (Failures)
+	{
+		printf("%d check(s) failed\n", Failures);
+		return 1;
+	}
+
+	printf("all checks passed\n");
+	return 0;
+}
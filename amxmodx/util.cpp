@@ -277,7 +277,7 @@ void UTIL_ClientPrint(edict_t *pEntity, int msg_dest, char *msg)
 	if (pEntity)
 		MESSAGE_BEGIN(MSG_ONE, gmsgTextMsg, NULL, pEntity);
 	else
-		MESSAGE_BEGIN(MSG_BROADCAST, gmsgTextMsg);
+		MESSAGE_BEGIN(MSG_ALL, gmsgTextMsg);	// reliable, as MSG_ONE is
 	
 	WRITE_BYTE(msg_dest);	// 1 byte
 	if (canUseFormatString) 
@@ -301,7 +301,11 @@ void UTIL_ClientSayText(edict_t *pEntity, int sender, char *msg)
 	char c = msg[index];
 	msg[index] = 0;			// truncate without checking with strlen()
 
-	MESSAGE_BEGIN(MSG_ONE, gmsgSayText, NULL, pEntity);
+	if (pEntity)
+		MESSAGE_BEGIN(MSG_ONE, gmsgSayText, NULL, pEntity);
+	else
+		MESSAGE_BEGIN(MSG_ALL, gmsgSayText);
+	
 	WRITE_BYTE(sender);		// 1 byte
 	if (canUseFormatString) 
 		WRITE_STRING("%s");	// 3 bytes (2 + EOS)
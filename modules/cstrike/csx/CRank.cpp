@@ -51,8 +51,19 @@ RankSystem::RankStats::RankStats( const char* uu, const char* nn, RankSystem* pp
 	uniquelen = 0;
 	score = 0;
 	parent = pp;
-	id = ++parent->rankNum;
+	++parent->rankNum;
 	next = prev = 0;
+	ranked = false;
+	stamp = ++parent->stampNum;
+	treeParent = treeLeft = treeRight = 0;
+	treeSize = 1;
+	// xorshift, only needs to look random enough to keep the tree balanced
+	parent->seed ^= parent->seed << 13;
+	parent->seed ^= parent->seed >> 17;
+	parent->seed ^= parent->seed << 5;
+	treePriority = parent->seed;
+	slot = -1;
+	dirty = true;
 	setName( nn );
 	setUnique( uu );
 }
@@ -64,6 +75,7 @@ RankSystem::RankStats::~RankStats() {
 }
 
 void RankSystem::RankStats::setName( const char* nn  )	{
+	dirty = true;
 	delete[] name;
 	namelen = strlen(nn) + 1;
 	name = new char[namelen];
@@ -86,11 +98,18 @@ void RankSystem::RankStats::setUnique( const char* nn  )	{
 RankSystem::RankSystem() { 
 	head = 0; 
 	tail = 0; 
+	root = 0;
 	rankNum = 0;
+	stampNum = 0;
+	seed = 2463534242u;
+	savePath[0] = 0;
+	slotNum = 0;
+	rewrite = true;
 	calc.code = 0;
 }
 
 RankSystem::~RankSystem() {
+	waitForSave();
 	clear();
 }
 
@@ -135,6 +154,153 @@ void RankSystem::clear(){
 		delete tail;
 		tail = head;
 	}
+	root = 0;
+	uniqueIndex.clear();
+	addressIndex.clear();
+	slotNum = 0;
+	rewrite = true;
+}
+
+bool RankSystem::ranksBefore( const RankStats* a, const RankStats* b ) const {
+	if ( a->ranked != b->ranked )
+		return a->ranked;
+	if ( !a->ranked )	// new entries stay in the order they came in
+		return a->stamp < b->stamp;
+	if ( a->score != b->score )
+		return a->score > b->score;
+	return a->stamp > b->stamp;
+}
+
+void RankSystem::rotateUp( RankStats* r ) {
+	RankStats* p = r->treeParent;
+	RankStats* g = p->treeParent;
+
+	if ( p->treeLeft == r ) {
+		p->treeLeft = r->treeRight;
+		if ( p->treeLeft ) p->treeLeft->treeParent = p;
+		r->treeRight = p;
+	}
+	else {
+		p->treeRight = r->treeLeft;
+		if ( p->treeRight ) p->treeRight->treeParent = p;
+		r->treeLeft = p;
+	}
+
+	p->treeParent = r;
+	r->treeParent = g;
+	if ( !g ) root = r;
+	else if ( g->treeLeft == p ) g->treeLeft = r;
+	else g->treeRight = r;
+
+	r->treeSize = p->treeSize;
+	p->treeSize = 1 + ( p->treeLeft ? p->treeLeft->treeSize : 0 ) + ( p->treeRight ? p->treeRight->treeSize : 0 );
+}
+
+void RankSystem::treeInsert( RankStats* r ) {
+	RankStats* p = 0;
+	RankStats** link = &root;
+
+	r->treeLeft = r->treeRight = 0;
+	r->treeSize = 1;
+
+	while ( *link ) {
+		p = *link;
+		++p->treeSize;
+		link = ranksBefore( r, p ) ? &p->treeLeft : &p->treeRight;
+	}
+
+	r->treeParent = p;
+	*link = r;
+
+	while ( r->treeParent && r->treeParent->treePriority < r->treePriority )
+		rotateUp( r );
+
+	// in-order predecessor is the next better entry in the list
+	RankStats* better = 0;
+	if ( r->treeLeft ) {
+		for ( better = r->treeLeft; better->treeRight; better = better->treeRight )
+			;
+	}
+	else {
+		for ( RankStats* c = r; c->treeParent; c = c->treeParent ) {
+			if ( c->treeParent->treeRight == c ) {
+				better = c->treeParent;
+				break;
+			}
+		}
+	}
+
+	put_before( r, better );
+}
+
+void RankSystem::treeRemove( RankStats* r ) {
+	RankStats* child;
+
+	while ( r->treeLeft || r->treeRight ) {
+		if ( !r->treeRight || ( r->treeLeft && r->treeLeft->treePriority > r->treeRight->treePriority ) )
+			child = r->treeLeft;
+		else
+			child = r->treeRight;
+		rotateUp( child );
+	}
+
+	RankStats* p = r->treeParent;
+	if ( !p ) root = 0;
+	else if ( p->treeLeft == r ) p->treeLeft = 0;
+	else p->treeRight = 0;
+
+	for ( ; p; p = p->treeParent )
+		--p->treeSize;
+
+	r->treeParent = 0;
+	unlink( r );
+}
+
+int RankSystem::getPosition( const RankStats* r ) const {
+	int position = ( r->treeLeft ? r->treeLeft->treeSize : 0 ) + 1;
+
+	for ( const RankStats* c = r; c->treeParent; c = c->treeParent ) {
+		if ( c->treeParent->treeRight == c )
+			position += ( c->treeParent->treeLeft ? c->treeParent->treeLeft->treeSize : 0 ) + 1;
+	}
+
+	return position;
+}
+
+RankSystem::RankStats* RankSystem::getEntryAt( int position ) const {
+	RankStats* r = root;
+	int left;
+
+	while ( r ) {
+		left = r->treeLeft ? r->treeLeft->treeSize : 0;
+		if ( position <= left )
+			r = r->treeLeft;
+		else if ( position == left + 1 )
+			return r;
+		else {
+			position -= left + 1;
+			r = r->treeRight;
+		}
+	}
+
+	return 0;
+}
+
+void RankSystem::addIndex( RankStats* r ) {
+	const char* unique = r->getUnique();
+	uniqueIndex.insert( unique, r );
+
+	// older saves keep "ip:port" uniques, IP lookups come without the port
+	const char* colon = strchr( unique, ':' );
+	if ( colon && unique[0] >= '0' && unique[0] <= '9' ) {
+		char address[64];
+		size_t len = colon - unique;
+		if ( len < sizeof(address) ) {
+			memcpy( address, unique, len );
+			address[len] = 0;
+			addressIndex.insert( address, r );	// keeps the first (best ranked on load) one
+		}
+	}
 }
 
 
@@ -159,58 +325,26 @@ void RankSystem::unloadCalc()
 
 RankSystem::RankStats* RankSystem::findEntryInRank(const char* unique, const char* name, bool isip)
 {
-	RankStats* a = head;
-	
-	if (isip) // IP lookups need to strip the port from already saved instances.
-	{         // Otherwise the stats file would be essentially reset.
-	
-		// The IP passed does not contain the port any more for unique
-		size_t iplen = strlen(unique);
-		
-		
-		while ( a )
-		{
-			const char* targetUnique = a->getUnique();
-			if ( strncmp( targetUnique, unique, iplen) == 0 )
-			{
-				// It mostly matches, make sure this isn't a false match
-				// eg: checking 4.2.2.2 would match 4.2.2.24 here.
-				
-				// Get the next character stored in targetUnique
-				char c = targetUnique[iplen];
-				
-				// If c is either a colon or end of line, then this
-				// is a valid match.
-				if (c == ':' ||
-					c == '\0')
-				{
-					// Yes, this is a match.
-					return a;
-				}
-				// Any other case was a false match.
-				
-			}
-			a = a->prev;
-		}
-	}
-	else // No special case
-	{
-		while ( a )
-		{
-			if (  strcmp( a->getUnique() ,unique ) == 0 )
-				return a;
+	RankStats* a;
+
+	if ( uniqueIndex.retrieve( unique, &a ) )
+		return a;
+
+	// IP lookups need to strip the port from already saved instances.
+	// Otherwise the stats file would be essentially reset.
+	if ( isip && addressIndex.retrieve( unique, &a ) )
+		return a;
 
-			a = a->prev;
-		}
-	}
 	a = new RankStats( unique ,name,this );
 	if ( a == 0 ) return 0;
-	put_after( a  , 0 );
+	treeInsert( a );
+	addIndex( a );
 	return a;
 }
 
 void RankSystem::updatePos(  RankStats* rr ,  Stats* s )
 {
+	rr->dirty = true;
 	rr->addStats( s );
 	if ( calc.code ) {
 		calc.physAddr1[0] = rr->kills;
@@ -239,31 +373,15 @@ void RankSystem::updatePos(  RankStats* rr ,  Stats* s )
 	else rr->score = rr->kills - rr->deaths;
 	
 
-	RankStats* aa = rr->next;
-	while ( aa && (aa->score <= rr->score) ) { // try to nominate
-		rr->goUp();
-		aa->goDown();
-		aa = aa->next;		// go to next rank
-	}
-	if ( aa != rr->next )
+	rr->ranked = true;
+	rr->stamp = ++stampNum;
+
+	// only touch the tree if it is out of place between its neighbours
+	if ( ( rr->next && !ranksBefore( rr->next, rr ) ) || ( rr->prev && !ranksBefore( rr, rr->prev ) ) )
 	{
-		unlink( rr );
-		put_before( rr, aa );
+		treeRemove( rr );
+		treeInsert( rr );
 	}
-	else
-	{
-		aa = rr->prev;
-		while ( aa && (aa->score > rr->score) ) { // go down
-			rr->goDown();
-			aa->goUp();
-			aa = aa->prev;	// go to prev rank
-		}
-		if ( aa != rr->prev ){
-			unlink( rr );
-			put_after( rr, aa );
-		}
-	}
-
 }
 
 /** 
@@ -274,8 +392,115 @@ void RankSystem::updatePos(  RankStats* rr ,  Stats* s )
 		break; \
 	}
 
+void RankSystem::loadLegacyRank( FILE* bfp )
+{
+	short int i = 0;
+	Stats d;
+	char unique[64], name[64];
+	if (fread(&i, sizeof(short int), 1, bfp) != 1)
+		return;
+
+	while(i && !feof(bfp))
+	{
+		TRYREAD(name, i, sizeof(char), bfp);
+		TRYREAD(&i, 1, sizeof(short int), bfp);
+		TRYREAD(unique , i, sizeof(char) , bfp);
+		TRYREAD(&d.tks, 1, sizeof(int), bfp);
+		TRYREAD(&d.damage, 1, sizeof(int), bfp);
+		TRYREAD(&d.deaths, 1, sizeof(int), bfp);
+		TRYREAD(&d.kills, 1, sizeof(int), bfp);
+		TRYREAD(&d.shots, 1, sizeof(int), bfp);
+		TRYREAD(&d.hits, 1, sizeof(int), bfp);
+		TRYREAD(&d.hs, 1, sizeof(int), bfp);
+		TRYREAD(&d.bDefusions, 1, sizeof(int), bfp);
+		TRYREAD(&d.bDefused, 1, sizeof(int), bfp);
+		TRYREAD(&d.bPlants, 1, sizeof(int), bfp);
+		TRYREAD(&d.bExplosions, 1, sizeof(int), bfp);
+		TRYREAD(d.bodyHits, 1, sizeof(d.bodyHits), bfp);
+		TRYREAD(&i, 1, sizeof(short int), bfp);
+
+		RankSystem::RankStats* a = findEntryInRank( unique , name );
+
+		if ( a ) a->updatePosition( &d );
+	}
+}
+
+void RankSystem::loadRecords( FILE* bfp )
+{
+	RankFileHeader header;
+	if ( fread( &header, sizeof(header), 1, bfp ) != 1 ||
+		header.headerSize != sizeof(RankFileHeader) ||
+		header.recordSize != sizeof(RankRecord) ||
+		header.recordNum < 0 )
+	{
+		MF_Log("Invalid csstats file header, stats will be reset");
+		return;
+	}
+
+	// a broken count must not size the block past what the file holds
+	long start = ftell( bfp );
+	fseek( bfp, 0, SEEK_END );
+	long left = ftell( bfp ) - start;
+	fseek( bfp, start, SEEK_SET );
+
+	if ( static_cast<unsigned long>(header.recordNum) > static_cast<unsigned long>(left) / sizeof(RankRecord) )
+	{
+		MF_Log("Invalid csstats file header, stats will be reset");
+		return;
+	}
+
+	// the records are one block, read it in one go
+	ke::Vector<RankRecord> records;
+	if ( !records.resize( header.recordNum ) )
+		return;
+
+	size_t read = header.recordNum ? fread( records.buffer(), sizeof(RankRecord), header.recordNum, bfp ) : 0;
+	bool merged = false;
+	Stats d;
+
+	for ( size_t i = 0; i < read; ++i )
+	{
+		RankRecord& record = records[i];
+		record.name[sizeof(record.name) - 1] = 0;
+		record.unique[sizeof(record.unique) - 1] = 0;
+
+		if ( !record.unique[0] )
+			continue;
+
+		d.tks = record.tks;
+		d.damage = record.damage;
+		d.deaths = record.deaths;
+		d.kills = record.kills;
+		d.shots = record.shots;
+		d.hits = record.hits;
+		d.hs = record.hs;
+		d.bDefusions = record.bDefusions;
+		d.bDefused = record.bDefused;
+		d.bPlants = record.bPlants;
+		d.bExplosions = record.bExplosions;
+		memcpy( d.bodyHits, record.bodyHits, sizeof(d.bodyHits) );
+
+		RankSystem::RankStats* a = findEntryInRank( record.unique, record.name );
+		if ( !a )
+			continue;
+
+		// a unique stored twice gets merged, the old slots have to go
+		if ( a->slot != -1 )
+			merged = true;
+
+		a->updatePosition( &d );
+		a->slot = static_cast<int>(i);
+		a->dirty = false;
+	}
+
+	slotNum = static_cast<int>(read);
+	rewrite = merged;
+}
+
 void RankSystem::loadRank( const char* filename )
 {
+	waitForSave();
+
 	FILE *bfp = fopen( filename , "rb" );
 	
 	if (!bfp) 
@@ -291,85 +516,131 @@ void RankSystem::loadRank( const char* filename )
 		return;
 	}
 	
-	if (i == RANK_VERSION)
+	if (i == RANK_FILE_VERSION)
 	{
-		Stats d;
-		char unique[64], name[64];
-		if (fread(&i, sizeof(short int), 1, bfp) != 1)
-		{
-			fclose(bfp);
-			return;
-		}
-
-		while(i && !feof(bfp))
-		{
-			TRYREAD(name, i, sizeof(char), bfp);
-			TRYREAD(&i, 1, sizeof(short int), bfp);
-			TRYREAD(unique , i, sizeof(char) , bfp);
-			TRYREAD(&d.tks, 1, sizeof(int), bfp);
-			TRYREAD(&d.damage, 1, sizeof(int), bfp);
-			TRYREAD(&d.deaths, 1, sizeof(int), bfp);
-			TRYREAD(&d.kills, 1, sizeof(int), bfp);
-			TRYREAD(&d.shots, 1, sizeof(int), bfp);
-			TRYREAD(&d.hits, 1, sizeof(int), bfp);
-			TRYREAD(&d.hs, 1, sizeof(int), bfp);
-			TRYREAD(&d.bDefusions, 1, sizeof(int), bfp);
-			TRYREAD(&d.bDefused, 1, sizeof(int), bfp);
-			TRYREAD(&d.bPlants, 1, sizeof(int), bfp);
-			TRYREAD(&d.bExplosions, 1, sizeof(int), bfp);
-			TRYREAD(d.bodyHits, 1, sizeof(d.bodyHits), bfp);
-			TRYREAD(&i, 1, sizeof(short int), bfp);
-
-			RankSystem::RankStats* a = findEntryInRank( unique , name );
-
-			if ( a ) a->updatePosition( &d );
-		}
+		fseek(bfp, 0, SEEK_SET);
+		loadRecords(bfp);
+	}
+	else if (i == RANK_VERSION)
+	{
+		loadLegacyRank(bfp);	// converted on the next save
 	}
 	fclose(bfp);
+
+	if (!rewrite)
+		ke::SafeStrcpy(savePath, sizeof(savePath), filename);
+}
+
+struct RankSaveJob
+{
+	FILE* bfp;
+	RankFileHeader header;
+	ke::Vector<int> slots;
+	ke::Vector<RankRecord> records;
+};
+
+static void WriteRankRecords( RankSaveJob* job )
+{
+	fseek( job->bfp, 0, SEEK_SET );
+	fwrite( &job->header, sizeof(RankFileHeader), 1, job->bfp );
+
+	for ( size_t i = 0; i < job->records.length(); ++i )
+	{
+		fseek( job->bfp, static_cast<long>(sizeof(RankFileHeader) + job->slots[i] * sizeof(RankRecord)), SEEK_SET );
+		fwrite( &job->records[i], sizeof(RankRecord), 1, job->bfp );
+	}
+
+	fclose( job->bfp );
+	delete job;
+}
+
+static void CopyRankString( char* dest, size_t maxlength, const char* src )
+{
+	strncpy( dest, src, maxlength - 1 );
+	dest[maxlength - 1] = 0;
+}
+
+void RankSystem::waitForSave()
+{
+	if ( saveThread.joinable() )
+		saveThread.join();
 }
 
 void RankSystem::saveRank( const char* filename )
 {
-	FILE *bfp = fopen(filename, "wb");
-	
-	if ( !bfp ) return;
+	waitForSave();
 
-	short int i = RANK_VERSION;
-	
-	fwrite(&i, 1, sizeof(short int) , bfp);
-	
-	RankSystem::iterator a = front();
-	
-	while ( a )
+	// either patch the records that changed, or write them all out again
+	FILE *bfp = 0;
+	bool full = rewrite || strcmp( savePath, filename ) != 0;
+
+	if ( !full && ( bfp = fopen( filename, "r+b" ) ) == 0 )
+		full = true;
+
+	if ( full && ( bfp = fopen( filename, "wb" ) ) == 0 )
+		return;
+
+	RankSaveJob* job = new RankSaveJob;
+	job->bfp = bfp;
+
+	if ( full )
 	{
-		if ( (*a).score != (1<<31) ) // score must be different than mincell
+		slotNum = 0;
+		for ( RankSystem::iterator a = front(); a; --a )
 		{
-			fwrite( &(*a).namelen , 1, sizeof(short int), bfp);
-			fwrite( (*a).name , (*a).namelen , sizeof(char) , bfp);
-			fwrite( &(*a).uniquelen , 1, sizeof(short int), bfp);
-			fwrite( (*a).unique ,  (*a).uniquelen , sizeof(char) , bfp);
-			fwrite( &(*a).tks, 1, sizeof(int), bfp);
-			fwrite( &(*a).damage, 1, sizeof(int), bfp);
-			fwrite( &(*a).deaths, 1, sizeof(int), bfp);
-			fwrite( &(*a).kills, 1, sizeof(int), bfp);
-			fwrite( &(*a).shots, 1, sizeof(int), bfp);
-			fwrite( &(*a).hits, 1, sizeof(int), bfp);
-			fwrite( &(*a).hs, 1, sizeof(int), bfp);
-
-			fwrite( &(*a).bDefusions, 1, sizeof(int), bfp);
-			fwrite( &(*a).bDefused, 1, sizeof(int), bfp);
-			fwrite( &(*a).bPlants, 1, sizeof(int), bfp);
-			fwrite( &(*a).bExplosions, 1, sizeof(int), bfp);
-
-			fwrite( (*a).bodyHits, 1, sizeof((*a).bodyHits), bfp);
+			(*a).slot = -1;
+			(*a).dirty = true;
 		}
-		
-		--a;
 	}
 
-	i = 0;
-	fwrite( &i , 1, sizeof(short int), bfp); // null terminator
-	
-	fclose(bfp);
-}
+	RankRecord record;
+	for ( RankSystem::iterator a = front(); a; --a )
+	{
+		RankStats& r = *a;
+		if ( !r.dirty )
+			continue;
+
+		memset( &record, 0, sizeof(record) );
 
+		if ( r.score != (1<<31) ) // score must be different than mincell
+		{
+			CopyRankString( record.name, sizeof(record.name), r.getName() );
+			CopyRankString( record.unique, sizeof(record.unique), r.getUnique() );
+			record.tks = r.tks;
+			record.damage = r.damage;
+			record.deaths = r.deaths;
+			record.kills = r.kills;
+			record.shots = r.shots;
+			record.hits = r.hits;
+			record.hs = r.hs;
+			record.bDefusions = r.bDefusions;
+			record.bDefused = r.bDefused;
+			record.bPlants = r.bPlants;
+			record.bExplosions = r.bExplosions;
+			memcpy( record.bodyHits, r.bodyHits, sizeof(record.bodyHits) );
+
+			if ( r.slot == -1 )
+				r.slot = slotNum++;
+		}
+		else if ( r.slot == -1 )
+		{
+			continue; // nothing saved for it yet, keep it that way
+		}
+		// else frees its slot
+
+		job->slots.append( r.slot );
+		job->records.append( record );
+		r.dirty = false;
+	}
+
+	job->header.version = RANK_FILE_VERSION;
+	job->header.headerSize = sizeof(RankFileHeader);
+	job->header.recordSize = sizeof(RankRecord);
+	job->header.recordNum = slotNum;
+
+	ke::SafeStrcpy( savePath, sizeof(savePath), filename );
+	rewrite = false;
+
+	// the snapshot is ours, writing it can be left to another thread
+	saveThread = std::thread( WriteRankRecords, job );
+}
@@ -14,9 +14,46 @@
 #ifndef CRANK_H
 #define CRANK_H
 
-#define RANK_VERSION 11
+#define RANK_VERSION 11			// variable length records, still read
+#define RANK_FILE_VERSION 12	// fixed size records, updated in place
 
 #include "amxxmodule.h"
+#include <sm_stringhashmap.h>
+#include <amtl/am-vector.h>
+#include <amtl/am-string.h>
+#include <thread>
+
+// *****************************************************
+// csstats.dat layout (RANK_FILE_VERSION)
+// *****************************************************
+
+// A header followed by recordNum fixed size records, a record is found
+// at headerSize + slot * recordSize. Slots with an empty unique are free.
+// Plain int32 fields only, so the file can be mapped as is.
+
+struct RankFileHeader {
+	int16_t version;		// first, where RANK_VERSION files keep theirs
+	int16_t headerSize;
+	int32_t recordSize;
+	int32_t recordNum;
+};
+
+struct RankRecord {
+	char name[64];
+	char unique[64];
+	int32_t tks;
+	int32_t damage;
+	int32_t deaths;
+	int32_t kills;
+	int32_t shots;
+	int32_t hits;
+	int32_t hs;
+	int32_t bDefusions;
+	int32_t bDefused;
+	int32_t bPlants;
+	int32_t bExplosions;
+	int32_t bodyHits[9];
+};
 
 // *****************************************************
 // class Stats
@@ -65,18 +102,24 @@ public:
 		char*		name;
 		short int	namelen;
 		int			score;
-		int			id;
+		bool		ranked;		// false until the first updatePosition, keeps it at the bottom
+		unsigned int	stamp;	// breaks score ties, the last updated goes first
+		RankStats*	treeParent;	// order statistic tree, in-order is rank order
+		RankStats*	treeLeft;
+		RankStats*	treeRight;
+		int			treeSize;
+		unsigned int	treePriority;
+		int			slot;		// record in the stats file, -1 if it has none yet
+		bool		dirty;		// changed since it was last saved
 		RankStats( const char* uu, const char* nn,  RankSystem* pp );
 		~RankStats();
 		void setUnique( const char* nn  );
-		inline void goDown() {++id;}
-		inline void goUp() {--id;}
 		inline void addStats(Stats* a) { commit( a ); }
 	public:
 		void setName( const char* nn  );
 		inline const char* getName() const { return name ? name : ""; }
 		inline const char* getUnique() const { return unique ? unique : ""; }
-		inline int getPosition() const { return id; }
+		inline int getPosition() const { return parent->getPosition( this ); }
 		inline void updatePosition( Stats* points ) {
 			parent->updatePos( this , points );
 		}
@@ -85,7 +128,18 @@ public:
 private:
 	RankStats* head;
 	RankStats* tail;
+	RankStats* root;
 	int rankNum;
+	unsigned int stampNum;
+	unsigned int seed;
+
+	StringHashMap<RankStats*> uniqueIndex;
+	StringHashMap<RankStats*> addressIndex;	// ip part of "ip:port" uniques from older saves
+
+	char savePath[256];		// file the slots refer to
+	int slotNum;
+	bool rewrite;			// slots are stale, the next save writes every record
+	std::thread saveThread;
 
 	struct scoreCalc{
 		AMX amx;
@@ -101,6 +155,16 @@ private:
 	void put_after( RankStats* a, RankStats* ptr );
 	void unlink( RankStats* ptr );
 	void updatePos( RankStats* r ,  Stats* s );
+
+	bool ranksBefore( const RankStats* a, const RankStats* b ) const;
+	void rotateUp( RankStats* r );
+	void treeInsert( RankStats* r );
+	void treeRemove( RankStats* r );
+	void addIndex( RankStats* r );
+	void loadRecords( FILE* bfp );
+	void loadLegacyRank( FILE* bfp );
+	int getPosition( const RankStats* r ) const;
+	RankStats* getEntryAt( int position ) const;
 	
 public:
 
@@ -109,6 +173,7 @@ public:
 
 	void saveRank( const char* filename );
 	void loadRank( const char* filename );
+	void waitForSave();
 	RankStats* findEntryInRank(const char* unique, const char* name, bool isip=false);
 	bool loadCalc(const char* filename, char* error, size_t maxLength);
 	inline int getRankNum( ) const { return rankNum; }
@@ -127,6 +192,7 @@ public:
 
 	inline iterator front() {  return iterator(head);  }
 	inline iterator begin() {  return iterator(tail);  }
+	inline iterator at( int position ) { return iterator(getEntryAt(position)); }
 };
 
 
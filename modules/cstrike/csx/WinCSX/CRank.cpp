@@ -11,6 +11,7 @@
 
 #include "CRank.h"
 #include <stdio.h>
+#include <string.h>
 
 // *****************************************************
 // class Stats
@@ -258,6 +259,92 @@ int RankSystem::updatePos(  RankStats* rr ,  Stats* s )
 	return rrFirst->getPosition();
 }
 
+void RankSystem::loadLegacyRank( FILE* bfp )
+{
+	short int i = 0;
+	Stats d;
+	char unique[64], name[64];
+	fread(&i , 1, sizeof(short int), bfp);
+
+	while( i )
+	{
+		fread(name , i,sizeof(char) , bfp);
+		fread(&i , 1, sizeof(short int), bfp);
+		fread(unique , i,sizeof(char) , bfp);
+		fread(&d.tks, 1,sizeof(int), bfp);
+		fread(&d.damage, 1,sizeof(int), bfp);
+		fread(&d.deaths, 1,sizeof(int), bfp);
+		fread(&d.kills, 1,sizeof(int), bfp);
+		fread(&d.shots, 1,sizeof(int), bfp);
+		fread(&d.hits, 1,sizeof(int), bfp);
+		fread(&d.hs, 1,sizeof(int), bfp);
+
+		fread(&d.bDefusions, 1,sizeof(int), bfp);
+		fread(&d.bDefused, 1,sizeof(int), bfp);
+		fread(&d.bPlants, 1,sizeof(int), bfp);
+		fread(&d.bExplosions, 1,sizeof(int), bfp);
+
+		fread(d.bodyHits, 1,sizeof(d.bodyHits), bfp);
+		fread(&i , 1, sizeof(short int), bfp);
+
+		RankSystem::RankStats* a = findEntryInRank( unique , name );
+
+		if ( a ) a->updatePosition( &d );
+	}
+}
+
+bool RankSystem::loadRecords( FILE* bfp )
+{
+	RankFileHeader header;
+	if ( fread( &header, sizeof(header), 1, bfp ) != 1 ||
+		header.headerSize != sizeof(RankFileHeader) ||
+		header.recordSize != sizeof(RankRecord) ||
+		header.recordNum < 0 )
+		return false;
+
+	long start = ftell( bfp );
+	fseek( bfp, 0, SEEK_END );
+	long left = ftell( bfp ) - start;
+	fseek( bfp, start, SEEK_SET );
+
+	if ( static_cast<unsigned long>(header.recordNum) > static_cast<unsigned long>(left) / sizeof(RankRecord) )
+		return false;
+
+	RankRecord record;
+	Stats d;
+
+	for ( int i = 0; i < header.recordNum; ++i )
+	{
+		if ( fread( &record, sizeof(record), 1, bfp ) != 1 )
+			return false;
+
+		record.name[sizeof(record.name) - 1] = 0;
+		record.unique[sizeof(record.unique) - 1] = 0;
+
+		if ( !record.unique[0] )	// free slot
+			continue;
+
+		d.tks = record.tks;
+		d.damage = record.damage;
+		d.deaths = record.deaths;
+		d.kills = record.kills;
+		d.shots = record.shots;
+		d.hits = record.hits;
+		d.hs = record.hs;
+		d.bDefusions = record.bDefusions;
+		d.bDefused = record.bDefused;
+		d.bPlants = record.bPlants;
+		d.bExplosions = record.bExplosions;
+		memcpy( d.bodyHits, record.bodyHits, sizeof(d.bodyHits) );
+
+		RankSystem::RankStats* a = findEntryInRank( record.unique, record.name );
+
+		if ( a ) a->updatePosition( &d );
+	}
+
+	return true;
+}
+
 bool RankSystem::loadRank( const char* filename )
 {
 	FILE *bfp = fopen( filename , "rb" );
@@ -268,42 +355,31 @@ bool RankSystem::loadRank( const char* filename )
 	
 	short int i = 0;
 	fread(&i, 1 , sizeof(short int) , bfp);
+
+	bool loaded = true;
 	
-	if (i == RANK_VERSION)
+	if (i == RANK_FILE_VERSION)
 	{
-		Stats d;
-		char unique[64], name[64];
-		fread(&i , 1, sizeof(short int), bfp);
-
-		while( i )
-		{
-			fread(name , i,sizeof(char) , bfp);
-			fread(&i , 1, sizeof(short int), bfp);
-			fread(unique , i,sizeof(char) , bfp);
-			fread(&d.tks, 1,sizeof(int), bfp);
-			fread(&d.damage, 1,sizeof(int), bfp);
-			fread(&d.deaths, 1,sizeof(int), bfp);
-			fread(&d.kills, 1,sizeof(int), bfp);
-			fread(&d.shots, 1,sizeof(int), bfp);
-			fread(&d.hits, 1,sizeof(int), bfp);
-			fread(&d.hs, 1,sizeof(int), bfp);
-
-			fread(&d.bDefusions, 1,sizeof(int), bfp);
-			fread(&d.bDefused, 1,sizeof(int), bfp);
-			fread(&d.bPlants, 1,sizeof(int), bfp);
-			fread(&d.bExplosions, 1,sizeof(int), bfp);
-
-			fread(d.bodyHits, 1,sizeof(d.bodyHits), bfp);
-			fread(&i , 1, sizeof(short int), bfp);
-
-			RankSystem::RankStats* a = findEntryInRank( unique , name );
-
-			if ( a ) a->updatePosition( &d );
-		}
+		fseek(bfp, 0, SEEK_SET);
+		loaded = loadRecords(bfp);
+	}
+	else if (i == RANK_VERSION)
+	{
+		loadLegacyRank(bfp);	// saved back as RANK_FILE_VERSION
+	}
+	else
+	{
+		loaded = false;			// unknown, never write over it
 	}
 	fclose(bfp);
 
-	return true;
+	return loaded;
+}
+
+static void CopyRankString( char* dest, size_t maxlength, const char* src )
+{
+	strncpy( dest, src, maxlength - 1 );
+	dest[maxlength - 1] = 0;
 }
 
 void RankSystem::saveRank( const char* filename )
@@ -312,41 +388,49 @@ void RankSystem::saveRank( const char* filename )
 	
 	if ( !bfp ) return;
 
-	short int i = RANK_VERSION;
-	
-	fwrite(&i, 1, sizeof(short int) , bfp);
+	// the whole file in rank order, the module keeps the slots on its next load
+	RankFileHeader header;
+	header.version = RANK_FILE_VERSION;
+	header.headerSize = sizeof(RankFileHeader);
+	header.recordSize = sizeof(RankRecord);
+	header.recordNum = 0;
+
+	fwrite(&header, sizeof(RankFileHeader), 1, bfp);
 	
 	RankSystem::iterator a = front();
+	RankRecord record;
 	
 	while ( a )
 	{
 		if ( (*a).score != (1<<31) ) // score must be different than mincell
 		{
-			fwrite( &(*a).namelen , 1, sizeof(short int), bfp);
-			fwrite( (*a).name , (*a).namelen , sizeof(char) , bfp);
-			fwrite( &(*a).uniquelen , 1, sizeof(short int), bfp);
-			fwrite( (*a).unique ,  (*a).uniquelen , sizeof(char) , bfp);
-			fwrite( &(*a).tks, 1, sizeof(int), bfp);
-			fwrite( &(*a).damage, 1, sizeof(int), bfp);
-			fwrite( &(*a).deaths, 1, sizeof(int), bfp);
-			fwrite( &(*a).kills, 1, sizeof(int), bfp);
-			fwrite( &(*a).shots, 1, sizeof(int), bfp);
-			fwrite( &(*a).hits, 1, sizeof(int), bfp);
-			fwrite( &(*a).hs, 1, sizeof(int), bfp);
-
-			fwrite( &(*a).bDefusions, 1, sizeof(int), bfp);
-			fwrite( &(*a).bDefused, 1, sizeof(int), bfp);
-			fwrite( &(*a).bPlants, 1, sizeof(int), bfp);
-			fwrite( &(*a).bExplosions, 1, sizeof(int), bfp);
-
-			fwrite( (*a).bodyHits, 1, sizeof((*a).bodyHits), bfp);
+			memset( &record, 0, sizeof(record) );
+			CopyRankString( record.name, sizeof(record.name), (*a).getName() );
+			CopyRankString( record.unique, sizeof(record.unique), (*a).getUnique() );
+			record.tks = (*a).tks;
+			record.damage = (*a).damage;
+			record.deaths = (*a).deaths;
+			record.kills = (*a).kills;
+			record.shots = (*a).shots;
+			record.hits = (*a).hits;
+			record.hs = (*a).hs;
+
+			record.bDefusions = (*a).bDefusions;
+			record.bDefused = (*a).bDefused;
+			record.bPlants = (*a).bPlants;
+			record.bExplosions = (*a).bExplosions;
+
+			memcpy( record.bodyHits, (*a).bodyHits, sizeof(record.bodyHits) );
+
+			fwrite( &record, sizeof(record), 1, bfp );
+			++header.recordNum;
 		}
 		
 		--a;
 	}
 
-	i = 0;
-	fwrite( &i , 1, sizeof(short int), bfp); // null terminator
+	fseek(bfp, 0, SEEK_SET);
+	fwrite(&header, sizeof(RankFileHeader), 1, bfp); // final record count
 	
 	fclose(bfp);
 }
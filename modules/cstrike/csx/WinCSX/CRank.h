@@ -10,10 +10,40 @@
 #ifndef CRANK_H
 #define CRANK_H
 
-#define RANK_VERSION 11
+#define RANK_VERSION 11			// variable length records, still read
+#define RANK_FILE_VERSION 12	// fixed size records, what the module writes
 
 #include "stdafx.h"
 #include "amxxmodule.h"
+#include <stdio.h>
+
+// *****************************************************
+// csstats.dat layout (RANK_FILE_VERSION), same as the CSX module
+// *****************************************************
+
+struct RankFileHeader {
+	int16_t version;
+	int16_t headerSize;
+	int32_t recordSize;
+	int32_t recordNum;
+};
+
+struct RankRecord {
+	char name[64];
+	char unique[64];
+	int32_t tks;
+	int32_t damage;
+	int32_t deaths;
+	int32_t kills;
+	int32_t shots;
+	int32_t hits;
+	int32_t hs;
+	int32_t bDefusions;
+	int32_t bDefused;
+	int32_t bPlants;
+	int32_t bExplosions;
+	int32_t bodyHits[9];
+};
 
 // *****************************************************
 // class Stats
@@ -101,6 +131,8 @@ private:
 	void put_after( RankStats* a, RankStats* ptr );
 	void unlink( RankStats* ptr );
 	int updatePos( RankStats* r ,  Stats* s );
+	bool loadRecords( FILE* bfp );
+	void loadLegacyRank( FILE* bfp );
 	
 public:
 
@@ -433,6 +433,7 @@ void OnAmxxAttach(){
 
 void OnAmxxDetach() {
 	g_grenades.clear();
+	g_rank.waitForSave();
 	g_rank.clear();
 	g_rank.unloadCalc();
 }
@@ -204,27 +204,26 @@ static cell AMX_NATIVE_CALL get_stats(AMX *amx, cell *params) /* 7 param */
 	
 	int index = params[1] + 1;
 
-	for(RankSystem::iterator a = g_rank.front(); a ;--a){
-		if ((*a).getPosition() == index)  {
-			cell *cpStats = MF_GetAmxAddr(amx,params[2]);
-			cell *cpBodyHits = MF_GetAmxAddr(amx,params[3]);
-			cpStats[0] = (*a).kills;
-			cpStats[1] = (*a).deaths;
-			cpStats[2] = (*a).hs;
-			cpStats[3] = (*a).tks;
-			cpStats[4] = (*a).shots;
-			cpStats[5] = (*a).hits;
-			cpStats[6] = (*a).damage;
-
-			cpStats[7] = (*a).getPosition();
-
-			MF_SetAmxString(amx,params[4],(*a).getName(),params[5]);
-			if (params[6] > 0)
-				MF_SetAmxString(amx, params[6], (*a).getUnique(), params[7]);
-			for(int i = 1; i < 8; ++i)
-				cpBodyHits[i] = (*a).bodyHits[i];
-			return --a ? index : 0;
-		}	
+	RankSystem::iterator a = g_rank.at(index);
+	if (a) {
+		cell *cpStats = MF_GetAmxAddr(amx,params[2]);
+		cell *cpBodyHits = MF_GetAmxAddr(amx,params[3]);
+		cpStats[0] = (*a).kills;
+		cpStats[1] = (*a).deaths;
+		cpStats[2] = (*a).hs;
+		cpStats[3] = (*a).tks;
+		cpStats[4] = (*a).shots;
+		cpStats[5] = (*a).hits;
+		cpStats[6] = (*a).damage;
+
+		cpStats[7] = (*a).getPosition();
+
+		MF_SetAmxString(amx,params[4],(*a).getName(),params[5]);
+		if (params[6] > 0)
+			MF_SetAmxString(amx, params[6], (*a).getUnique(), params[7]);
+		for(int i = 1; i < 8; ++i)
+			cpBodyHits[i] = (*a).bodyHits[i];
+		return --a ? index : 0;
 	}
 	
 	return 0;
@@ -235,19 +234,18 @@ static cell AMX_NATIVE_CALL get_stats2(AMX *amx, cell *params) /* 4 param */
 	
 	int index = params[1] + 1;
 
-	for(RankSystem::iterator a = g_rank.front(); a ;--a){
-		if ((*a).getPosition() == index)  {
-			cell *cpStats = MF_GetAmxAddr(amx,params[2]);
-			if (params[4] > 0)
-				MF_SetAmxString(amx, params[3], (*a).getUnique(), params[4]);
+	RankSystem::iterator a = g_rank.at(index);
+	if (a) {
+		cell *cpStats = MF_GetAmxAddr(amx,params[2]);
+		if (params[4] > 0)
+			MF_SetAmxString(amx, params[3], (*a).getUnique(), params[4]);
 
-			cpStats[0] = (*a).bDefusions;
-			cpStats[1] = (*a).bDefused;
-			cpStats[2] = (*a).bPlants;
-			cpStats[3] = (*a).bExplosions;
+		cpStats[0] = (*a).bDefusions;
+		cpStats[1] = (*a).bDefused;
+		cpStats[2] = (*a).bPlants;
+		cpStats[3] = (*a).bExplosions;
 
-			return --a ? index : 0;
-		}	
+		return --a ? index : 0;
 	}
 	
 	return 0;
@@ -12,6 +12,7 @@
 //
 
 #include "engine.h"
+#include "entindex.h"
 
 BOOL CheckForPublic(const char *publicname);
 void CreateDetours();
@@ -31,6 +32,8 @@ void ClearHooks()
 {
 	size_t i;
 
+	ClearDispatch();
+
 	for (i=0; i<Touches.length(); i++)
 		delete Touches[i];
 	for (i=0; i<Impulses.length(); i++)
@@ -43,6 +46,11 @@ void ClearHooks()
 	Thinks.clear();
 }
 
+void OnMetaAttach()
+{
+	REG_SVR_COMMAND("engine", EngineCommand);
+}
+
 void OnAmxxAttach()
 {
 	pfnTouchForward = 0;
@@ -223,6 +231,7 @@ void ServerDeactivate()
 	g_pFunctionTable->pfnTouch=NULL; // "pfn_touch","vexd_pfntouch"
 
 	ClearHooks();
+	g_EntityIndex.Clear();
 
 	RETURN_META(MRES_IGNORED);
 }
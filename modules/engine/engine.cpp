@@ -47,7 +47,7 @@ static cell AMX_NATIVE_CALL register_think(AMX *amx, cell *params)
 
 	p->Forward = MF_RegisterSPForwardByName(amx, MF_GetAmxString(amx, params[2], 0, &len), FP_CELL, FP_DONE);
 
-	Thinks.append(p);
+	AddThink(p);
 
 	if (!g_pFunctionTable->pfnThink)
 		g_pFunctionTable->pfnThink=Think;
@@ -57,20 +57,12 @@ static cell AMX_NATIVE_CALL register_think(AMX *amx, cell *params)
 
 static cell AMX_NATIVE_CALL unregister_think(AMX *amx, cell *params)
 {
-	int fwd = params[1];
-	for (size_t i = 0; i < Thinks.length(); ++i)
+	if (RemoveThink(params[1]))
 	{
-		EntClass *p = Thinks.at(i);
-		if (p->Forward == fwd)
-		{
-			Thinks.remove(i);
-			delete p;
+		if (!Thinks.length())
+			g_pFunctionTable->pfnThink = NULL;
 
-			if (!Thinks.length())
-				g_pFunctionTable->pfnThink = NULL;
-
-			return 1;
-		}
+		return 1;
 	}
 
 	return 0;
@@ -136,7 +128,7 @@ static cell AMX_NATIVE_CALL register_touch(AMX *amx, cell *params)
 
 	p->Forward = MF_RegisterSPForwardByName(amx, MF_GetAmxString(amx, params[3], 2, &len), FP_CELL, FP_CELL, FP_DONE);
 
-	Touches.append(p);
+	AddTouch(p);
 
 	if (!g_pFunctionTable->pfnTouch)
 		g_pFunctionTable->pfnTouch=pfnTouch;
@@ -146,20 +138,12 @@ static cell AMX_NATIVE_CALL register_touch(AMX *amx, cell *params)
 
 static cell AMX_NATIVE_CALL unregister_touch(AMX *amx, cell *params)
 {
-	int fwd = params[1];
-	for (size_t i = 0; i < Touches.length(); ++i)
+	if (RemoveTouch(params[1]))
 	{
-		Touch *p = Touches.at(i);
-		if (p->Forward == fwd)
-		{
-			Touches.remove(i);
-			delete p;
+		if (!Touches.length())
+			g_pFunctionTable->pfnTouch = NULL;
 
-			if (!Touches.length())
-				g_pFunctionTable->pfnTouch = NULL;
-
-			return 1;
-		}
+		return 1;
 	}
 
 	return 0;
@@ -26,6 +26,7 @@
 #include <amtl/am-vector.h>
 #include <amtl/am-string.h>
 #include <amtl/am-algorithm.h>
+#include <sm_stringhashmap.h>
 #include <CDetour/detours.h>
 #include <HLTypeConversion.h>
 
@@ -145,6 +146,7 @@ class Touch
 {
 public:
 	int Forward;
+	unsigned int Order;		// registration order, kept across the class buckets
 	ke::AString Toucher;
 	ke::AString Touched;
 	~Touch()
@@ -166,6 +168,31 @@ public:
 	}
 };
 
+typedef ke::Vector<EntClass *> ThinkList;
+typedef ke::Vector<Touch *> TouchList;
+
+// Touches of one toucher classname (or of any toucher), split by touched classname
+class TouchClass
+{
+public:
+	TouchList AnyTouched;
+	StringHashMap<TouchList *> Touched;
+	~TouchClass();
+};
+
+struct DispatchStats
+{
+	uint64_t executed;		// callbacks that matched at least one registration
+	uint64_t skipped;		// callbacks that matched nothing
+};
+
+void AddThink(EntClass *p);
+bool RemoveThink(int fwd);
+void AddTouch(Touch *p);
+bool RemoveTouch(int fwd);
+void ClearDispatch();
+void EngineCommand();
+
 int is_ent_valid(int iEnt);
 int AmxStringToEngine(AMX *amx, cell param, int &len);
 edict_t *UTIL_FindEntityInSphere(edict_t *pStart, const Vector &vecCenter, float flRadius);
@@ -224,6 +251,8 @@ extern AMX_NATIVE_INFO engine_NewNatives[];
 extern ke::Vector<Impulse *> Impulses;
 extern ke::Vector<EntClass *> Thinks;
 extern ke::Vector<Touch *> Touches;
+extern DispatchStats ThinkStats;
+extern DispatchStats TouchStats;
 
 #endif //_ENGINE_INCLUDE_H
 
@@ -0,0 +1,371 @@
+// vim: set ts=4 sw=4 tw=99 noet:
+//
+// AMX Mod X, based on AMX Mod by Aleksander Naszko ("OLO").
+// Copyright (C) The AMX Mod X Development Team.
+//
+// This software is licensed under the GNU General Public License, version 3 or higher.
+// Additional exceptions apply. For full license details, see LICENSE.txt or visit:
+//     https://alliedmods.net/amxmodx-license
+
+//
+// Engine Module
+//
+
+#include "entindex.h"
+
+#define ENTINDEX_CELLS		(ENTINDEX_GRID_SIZE * ENTINDEX_GRID_SIZE)
+#define ENTINDEX_SMALL_SET	32		// classes this small are walked instead of the grid
+
+EntityIndex g_EntityIndex;
+
+static int SortEntities(const void *a, const void *b)
+{
+	return *static_cast<const cell *>(a) - *static_cast<const cell *>(b);
+}
+
+EntityIndex::EntityIndex() : m_Active(false), m_RefreshTime(-1.0f), m_Entities(0), m_Query(0)
+{
+	memset(m_CellStart, 0, sizeof(m_CellStart));
+}
+
+EntityIndex::~EntityIndex()
+{
+	Clear();
+}
+
+void EntityIndex::Clear()
+{
+	for (StringHashMap<ClassSet *>::iterator iter = m_Classes.iter(); !iter.empty(); iter.next())
+	{
+		delete (*iter).value;
+	}
+
+	m_Classes.clear();
+	m_Info.clear();
+	m_Mark.clear();
+	m_CellItems.clear();
+	m_Oversized.clear();
+	memset(m_CellStart, 0, sizeof(m_CellStart));
+
+	m_Active = false;
+	m_RefreshTime = -1.0f;
+	m_Entities = 0;
+	m_Query = 0;
+}
+
+int EntityIndex::CellCoord(float value)
+{
+	int coord = static_cast<int>((value + (ENTINDEX_CELL_SIZE * ENTINDEX_GRID_SIZE / 2)) / ENTINDEX_CELL_SIZE);
+
+	if (coord < 0)
+		return 0;
+	if (coord >= ENTINDEX_GRID_SIZE)
+		return ENTINDEX_GRID_SIZE - 1;
+
+	return coord;
+}
+
+EntityIndex::ClassSet *EntityIndex::GetSet(const char *classname, bool create)
+{
+	ClassSet *set;
+
+	if (!m_Classes.retrieve(classname, &set))
+	{
+		if (!create)
+			return NULL;
+
+		set = new ClassSet;
+		m_Classes.insert(classname, set);
+	}
+
+	return set;
+}
+
+bool EntityIndex::IsSearchable(int index, edict_t *pEdict)
+{
+	if (index < 1 || FNullEnt(pEdict) || pEdict->free || !pEdict->v.classname)
+		return false;
+
+	if (index <= gpGlobals->maxClients && !MF_IsPlayerIngame(index))
+		return false;
+
+	return true;
+}
+
+bool EntityIndex::InSphere(edict_t *pEdict, const Vector &origin, float radiusSquared)
+{
+	// same test as the engine, distance to the closest point of the box
+	float distSquared = 0.0f;
+	float delta;
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (origin[i] < pEdict->v.absmin[i])
+			delta = origin[i] - pEdict->v.absmin[i];
+		else if (origin[i] > pEdict->v.absmax[i])
+			delta = origin[i] - pEdict->v.absmax[i];
+		else
+			continue;
+
+		distSquared += delta * delta;
+	}
+
+	return distSquared <= radiusSquared;
+}
+
+void EntityIndex::UpdateClass(int index, edict_t *pEdict)
+{
+	EntityInfo &info = m_Info[index];
+	string_t classname = IsSearchable(index, pEdict) ? pEdict->v.classname : 0;
+
+	if (classname == info.classname)
+		return;
+
+	if (info.set)
+	{
+		EntityList &ents = info.set->ents;
+		size_t low = 0, high = ents.length();
+
+		while (low < high)
+		{
+			size_t mid = (low + high) / 2;
+			if (ents[mid] < index)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+
+		if (low < ents.length() && ents[low] == index)
+			ents.remove(low);
+	}
+
+	info.classname = classname;
+	info.set = NULL;
+
+	if (!classname)
+		return;
+
+	info.set = GetSet(STRING(classname), true);
+
+	EntityList &ents = info.set->ents;
+	size_t pos = ents.length();
+
+	while (pos > 0 && ents[pos - 1] > index)
+		pos--;
+
+	ents.insert(pos, index);
+}
+
+void EntityIndex::RebuildGrid()
+{
+	int cursor[ENTINDEX_CELLS];
+	int x, y;
+
+	memset(m_CellStart, 0, sizeof(m_CellStart));
+	m_Oversized.clear();
+
+	for (int i = 1; i < static_cast<int>(m_Info.length()); i++)
+	{
+		EntityInfo &info = m_Info[i];
+
+		info.cells = -1;
+
+		if (!info.set)
+			continue;
+
+		edict_t *pEdict = TypeConversion.id_to_edict(i);
+
+		info.x0 = CellCoord(pEdict->v.absmin.x);
+		info.y0 = CellCoord(pEdict->v.absmin.y);
+		info.x1 = CellCoord(pEdict->v.absmax.x);
+		info.y1 = CellCoord(pEdict->v.absmax.y);
+		info.cells = (info.x1 - info.x0 + 1) * (info.y1 - info.y0 + 1);
+
+		if (info.cells > ENTINDEX_MAX_SPAN)
+		{
+			info.cells = 0;
+			m_Oversized.append(i);
+			continue;
+		}
+
+		for (x = info.x0; x <= info.x1; x++)
+		{
+			for (y = info.y0; y <= info.y1; y++)
+			{
+				m_CellStart[x * ENTINDEX_GRID_SIZE + y + 1]++;
+			}
+		}
+	}
+
+	for (x = 1; x <= ENTINDEX_CELLS; x++)
+	{
+		m_CellStart[x] += m_CellStart[x - 1];
+	}
+
+	m_CellItems.resize(m_CellStart[ENTINDEX_CELLS]);
+	memcpy(cursor, m_CellStart, sizeof(cursor));
+
+	for (int i = 1; i < static_cast<int>(m_Info.length()); i++)
+	{
+		EntityInfo &info = m_Info[i];
+
+		if (info.cells <= 0)
+			continue;
+
+		for (x = info.x0; x <= info.x1; x++)
+		{
+			for (y = info.y0; y <= info.y1; y++)
+			{
+				m_CellItems[cursor[x * ENTINDEX_GRID_SIZE + y]++] = i;
+			}
+		}
+	}
+}
+
+void EntityIndex::Refresh()
+{
+	if (m_Active && m_RefreshTime == gpGlobals->time && m_Entities == gpGlobals->maxEntities)
+		return;
+
+	m_Active = true;
+	m_RefreshTime = gpGlobals->time;
+
+	if (m_Entities != gpGlobals->maxEntities)
+	{
+		size_t length = m_Info.length();
+
+		m_Entities = gpGlobals->maxEntities;
+		m_Info.resize(m_Entities + 1);
+		m_Mark.resize(m_Entities + 1);
+
+		for (; length < m_Info.length(); length++)
+		{
+			m_Info[length].classname = 0;
+			m_Info[length].set = NULL;
+			m_Info[length].cells = -1;
+			m_Mark[length] = 0;
+		}
+	}
+
+	for (int i = 1; i <= m_Entities; i++)
+	{
+		UpdateClass(i, TypeConversion.id_to_edict(i));
+	}
+
+	RebuildGrid();
+}
+
+void EntityIndex::Test(int index, ClassSet *set, const Vector &origin, float radiusSquared, ke::Vector<cell> &hits)
+{
+	// entities over several cells are seen more than once
+	if (m_Mark[index] == m_Query)
+		return;
+
+	m_Mark[index] = m_Query;
+
+	if (set && m_Info[index].set != set)
+		return;
+
+	edict_t *pEdict = TypeConversion.id_to_edict(index);
+
+	if (IsSearchable(index, pEdict) && pEdict->v.classname == m_Info[index].classname && InSphere(pEdict, origin, radiusSquared))
+		hits.append(index);
+}
+
+int EntityIndex::FindInSphere(const Vector &origin, float radius, const char *classname, cell *list, int max)
+{
+	ClassSet *set = NULL;
+	float radiusSquared = radius * radius;
+	ke::Vector<cell> hits;
+	edict_t *pEdict;
+	int index;
+	size_t i;
+
+	Refresh();
+
+	if (classname && *classname)
+	{
+		if ((set = GetSet(classname, false)) == NULL)
+			return 0;
+	}
+
+	if (set && set->ents.length() <= ENTINDEX_SMALL_SET)
+	{
+		for (i = 0; i < set->ents.length(); i++)
+		{
+			index = set->ents[i];
+			pEdict = TypeConversion.id_to_edict(index);
+
+			// the index is as old as the frame, make sure the entity still is what it was
+			if (IsSearchable(index, pEdict) && pEdict->v.classname == m_Info[index].classname && InSphere(pEdict, origin, radiusSquared))
+				hits.append(index);
+		}
+	}
+	else
+	{
+		if (++m_Query == 0)
+		{
+			for (i = 0; i < m_Mark.length(); i++)
+				m_Mark[i] = 0;
+
+			m_Query = 1;
+		}
+
+		int x0 = CellCoord(origin.x - radius), x1 = CellCoord(origin.x + radius);
+		int y0 = CellCoord(origin.y - radius), y1 = CellCoord(origin.y + radius);
+		int j, slot;
+
+		for (int x = x0; x <= x1; x++)
+		{
+			for (int y = y0; y <= y1; y++)
+			{
+				slot = x * ENTINDEX_GRID_SIZE + y;
+
+				for (j = m_CellStart[slot]; j < m_CellStart[slot + 1]; j++)
+				{
+					Test(m_CellItems[j], set, origin, radiusSquared, hits);
+				}
+			}
+		}
+
+		for (i = 0; i < m_Oversized.length(); i++)
+		{
+			Test(m_Oversized[i], set, origin, radiusSquared, hits);
+		}
+
+		qsort(hits.buffer(), hits.length(), sizeof(cell), SortEntities);
+	}
+
+	int found = 0;
+
+	for (i = 0; i < hits.length() && found < max; i++)
+	{
+		list[found++] = hits[i];
+	}
+
+	return found;
+}
+
+int EntityIndex::FindByClass(const char *classname, cell *list, int max)
+{
+	ClassSet *set;
+	edict_t *pEdict;
+	int index;
+	int found = 0;
+
+	Refresh();
+
+	if ((set = GetSet(classname, false)) == NULL)
+		return 0;
+
+	for (size_t i = 0; i < set->ents.length() && found < max; i++)
+	{
+		index = set->ents[i];
+		pEdict = TypeConversion.id_to_edict(index);
+
+		if (IsSearchable(index, pEdict) && pEdict->v.classname == m_Info[index].classname)
+			list[found++] = index;
+	}
+
+	return found;
+}
@@ -0,0 +1,91 @@
+// vim: set ts=4 sw=4 tw=99 noet:
+//
+// AMX Mod X, based on AMX Mod by Aleksander Naszko ("OLO").
+// Copyright (C) The AMX Mod X Development Team.
+//
+// This software is licensed under the GNU General Public License, version 3 or higher.
+// Additional exceptions apply. For full license details, see LICENSE.txt or visit:
+//     https://alliedmods.net/amxmodx-license
+
+//
+// Engine Module
+//
+
+#ifndef _INCLUDE_ENGINE_ENTINDEX
+#define _INCLUDE_ENGINE_ENTINDEX
+
+#include "engine.h"
+
+// Uniform grid over the map plus a classname -> entities index, used by the
+// batch find natives. Nothing is built until one of them is called; from then
+// on the index is refreshed at most once per frame, by diffing each edict
+// against what was seen on the previous refresh.
+//
+// Cells cover the x/y plane only, entities are put in every cell their
+// absmin/absmax box overlaps and huge ones are kept aside and always tested.
+
+#define ENTINDEX_CELL_SIZE	256
+#define ENTINDEX_GRID_SIZE	32		// cells per axis, covers -4096..4096
+#define ENTINDEX_MAX_SPAN	16		// entities over more cells than this are tested on every query
+
+class EntityIndex
+{
+public:
+	typedef ke::Vector<int> EntityList;
+
+	EntityIndex();
+	~EntityIndex();
+
+	// Fills the list with entities whose bounding box intersects the sphere,
+	// optionally only entities of a classname.
+	int FindInSphere(const Vector &origin, float radius, const char *classname, cell *list, int max);
+
+	// Fills the list with entities of a classname, by ascending index.
+	int FindByClass(const char *classname, cell *list, int max);
+
+	// Called when the map goes down, edicts are about to be freed.
+	void Clear();
+
+private:
+	struct ClassSet
+	{
+		EntityList ents;		// sorted
+	};
+
+	struct EntityInfo
+	{
+		string_t classname;		// classname seen at last refresh
+		ClassSet *set;
+		int cells;				// -1 not in grid, 0 oversized, else cell count
+		short x0, y0, x1, y1;	// cell span
+	};
+
+	void Refresh();
+	void UpdateClass(int index, edict_t *pEdict);
+	void RebuildGrid();
+	bool IsSearchable(int index, edict_t *pEdict);
+	bool InSphere(edict_t *pEdict, const Vector &origin, float radiusSquared);
+	void Test(int index, ClassSet *set, const Vector &origin, float radiusSquared, ke::Vector<cell> &hits);
+	ClassSet *GetSet(const char *classname, bool create);
+
+	static int CellCoord(float value);
+
+private:
+	bool m_Active;
+	float m_RefreshTime;
+	int m_Entities;
+
+	ke::Vector<EntityInfo> m_Info;
+	StringHashMap<ClassSet *> m_Classes;
+
+	int m_CellStart[ENTINDEX_GRID_SIZE * ENTINDEX_GRID_SIZE + 1];
+	EntityList m_CellItems;
+	EntityList m_Oversized;
+
+	ke::Vector<unsigned int> m_Mark;	// per entity, last query that reported it
+	unsigned int m_Query;
+};
+
+extern EntityIndex g_EntityIndex;
+
+#endif //_INCLUDE_ENGINE_ENTINDEX
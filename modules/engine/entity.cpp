@@ -12,6 +12,7 @@
 //
 
 #include "entity.h"
+#include "entindex.h"
 
 int is_ent_valid(int iEnt)
 {
@@ -1417,6 +1418,30 @@ static cell AMX_NATIVE_CALL find_sphere_class(AMX *amx, cell *params) // find_sp
 	return entsFound;
 }
 
+// find_ents_in_sphere(const Float:origin[3], Float:radius, entlist[], maxents, const classname[] = "")
+static cell AMX_NATIVE_CALL find_ents_in_sphere(AMX *amx, cell *params)
+{
+	cell *cAddr = MF_GetAmxAddr(amx, params[1]);
+	Vector vecOrigin(amx_ctof(cAddr[0]), amx_ctof(cAddr[1]), amx_ctof(cAddr[2]));
+	REAL radius = amx_ctof(params[2]);
+	cell *entList = MF_GetAmxAddr(amx, params[3]);
+
+	int len;
+	const char *classname = MF_GetAmxString(amx, params[5], 0, &len);
+
+	return g_EntityIndex.FindInSphere(vecOrigin, radius, classname, entList, params[4]);
+}
+
+// find_ents_by_class(const classname[], entlist[], maxents)
+static cell AMX_NATIVE_CALL find_ents_by_class(AMX *amx, cell *params)
+{
+	int len;
+	const char *classname = MF_GetAmxString(amx, params[1], 0, &len);
+	cell *entList = MF_GetAmxAddr(amx, params[2]);
+
+	return g_EntityIndex.FindByClass(classname, entList, params[3]);
+}
+
 static cell AMX_NATIVE_CALL find_ent_by_target(AMX *amx, cell *params)
 {
 	int iStart = params[1];
@@ -1617,6 +1642,8 @@ AMX_NATIVE_INFO ent_Natives[] = {
 	{"find_ent_in_sphere",	find_ent_in_sphere},
 	{"find_ent_by_class",	find_ent_by_class},
 	{"find_sphere_class",	find_sphere_class},
+	{"find_ents_in_sphere",	find_ents_in_sphere},
+	{"find_ents_by_class",	find_ents_by_class},
 	{"find_ent_by_model",	find_ent_by_model},
 	{"find_ent_by_target",	find_ent_by_target},
 	{"find_ent_by_tname",	find_ent_by_tname},
@@ -31,6 +31,8 @@ int VexdServerForward = 0;
 ke::Vector<Impulse *> Impulses;
 ke::Vector<EntClass *> Thinks;
 ke::Vector<Touch *> Touches;
+DispatchStats ThinkStats;
+DispatchStats TouchStats;
 KeyValueData *g_pkvd;
 bool g_inKeyValue=false;
 bool g_precachedStuff = false;
@@ -241,50 +243,263 @@ void PlayerPostThink_Post(edict_t *pEntity)
 	RETURN_META(MRES_IGNORED);
 }
 
+// register_think/register_touch indexed by classname, so an unregistered
+// class costs one lookup instead of a compare per registration.
+// Buckets are only freed by ClearDispatch(), a forward may unregister
+// itself while its bucket is being walked.
+static StringHashMap<ThinkList *> ThinkIndex;
+static StringHashMap<TouchClass *> TouchIndex;	// keyed by toucher classname
+static TouchClass AnyToucher;					// registered with a "*" toucher
+static unsigned int TouchOrder = 0;
+
+TouchClass::~TouchClass()
+{
+	for (StringHashMap<TouchList *>::iterator iter = Touched.iter(); !iter.empty(); iter.next())
+	{
+		delete (*iter).value;
+	}
+}
+
+void AddThink(EntClass *p)
+{
+	ThinkList *list;
+
+	if (!ThinkIndex.retrieve(p->Class.chars(), &list))
+	{
+		list = new ThinkList;
+		ThinkIndex.insert(p->Class.chars(), list);
+	}
+
+	list->append(p);
+	Thinks.append(p);
+}
+
+bool RemoveThink(int fwd)
+{
+	for (size_t i = 0; i < Thinks.length(); ++i)
+	{
+		EntClass *p = Thinks.at(i);
+		if (p->Forward == fwd)
+		{
+			ThinkList *list;
+			if (ThinkIndex.retrieve(p->Class.chars(), &list))
+			{
+				for (size_t j = 0; j < list->length(); ++j)
+				{
+					if (list->at(j) == p)
+					{
+						list->remove(j);
+						break;
+					}
+				}
+			}
+
+			Thinks.remove(i);
+			delete p;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static TouchList *GetTouchList(Touch *p, bool create)
+{
+	TouchClass *toucher = &AnyToucher;
+
+	if (p->Toucher.length())
+	{
+		if (!TouchIndex.retrieve(p->Toucher.chars(), &toucher))
+		{
+			if (!create)
+				return NULL;
+
+			toucher = new TouchClass;
+			TouchIndex.insert(p->Toucher.chars(), toucher);
+		}
+	}
+
+	if (!p->Touched.length())
+		return &toucher->AnyTouched;
+
+	TouchList *list;
+
+	if (!toucher->Touched.retrieve(p->Touched.chars(), &list))
+	{
+		if (!create)
+			return NULL;
+
+		list = new TouchList;
+		toucher->Touched.insert(p->Touched.chars(), list);
+	}
+
+	return list;
+}
+
+void AddTouch(Touch *p)
+{
+	p->Order = TouchOrder++;
+
+	GetTouchList(p, true)->append(p);
+	Touches.append(p);
+}
+
+bool RemoveTouch(int fwd)
+{
+	for (size_t i = 0; i < Touches.length(); ++i)
+	{
+		Touch *p = Touches.at(i);
+		if (p->Forward == fwd)
+		{
+			TouchList *list = GetTouchList(p, false);
+			if (list)
+			{
+				for (size_t j = 0; j < list->length(); ++j)
+				{
+					if (list->at(j) == p)
+					{
+						list->remove(j);
+						break;
+					}
+				}
+			}
+
+			Touches.remove(i);
+			delete p;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ClearDispatch()
+{
+	for (StringHashMap<ThinkList *>::iterator iter = ThinkIndex.iter(); !iter.empty(); iter.next())
+	{
+		delete (*iter).value;
+	}
+
+	for (StringHashMap<TouchClass *>::iterator iter = TouchIndex.iter(); !iter.empty(); iter.next())
+	{
+		delete (*iter).value;
+	}
+
+	for (StringHashMap<TouchList *>::iterator iter = AnyToucher.Touched.iter(); !iter.empty(); iter.next())
+	{
+		delete (*iter).value;
+	}
+
+	ThinkIndex.clear();
+	TouchIndex.clear();
+	AnyToucher.Touched.clear();
+	AnyToucher.AnyTouched.clear();
+	TouchOrder = 0;
+}
+
+void EngineCommand()
+{
+	const char *cmd = CMD_ARGV(1);
+
+	if (strcmp(cmd, "stats") == 0)
+	{
+		MF_PrintSrvConsole("%-8s | %8s | %14s | %14s\n", "Callback", "Hooks", "Executed", "Skipped");
+		MF_PrintSrvConsole("------------------------------------------------------\n");
+		MF_PrintSrvConsole("%-8s | %8u | %14llu | %14llu\n", "think", static_cast<unsigned int>(Thinks.length()), static_cast<unsigned long long>(ThinkStats.executed), static_cast<unsigned long long>(ThinkStats.skipped));
+		MF_PrintSrvConsole("%-8s | %8u | %14llu | %14llu\n", "touch", static_cast<unsigned int>(Touches.length()), static_cast<unsigned long long>(TouchStats.executed), static_cast<unsigned long long>(TouchStats.skipped));
+		return;
+	}
+	else if (strcmp(cmd, "resetstats") == 0)
+	{
+		memset(&ThinkStats, 0, sizeof(ThinkStats));
+		memset(&TouchStats, 0, sizeof(TouchStats));
+		MF_PrintSrvConsole("Engine dispatch counters cleared.\n");
+		return;
+	}
+
+	MF_PrintSrvConsole("Usage: engine < command > [ argument ]\n");
+	MF_PrintSrvConsole("Commands:\n");
+	MF_PrintSrvConsole("   %-22s - %s\n", "stats", "Shows register_think/register_touch dispatch counters.");
+	MF_PrintSrvConsole("   %-22s - %s\n", "resetstats", "Clears the dispatch counters.");
+}
+
 void pfnTouch(edict_t *pToucher, edict_t *pTouched)
 {
-	unsigned int i = 0;
 	int retVal = 0;
 	const char *ptrClass = STRING(pToucher->v.classname);
 	const char *ptdClass = STRING(pTouched->v.classname);
 	int ptrIndex = TypeConversion.edict_to_id(pToucher);
 	int ptdIndex = TypeConversion.edict_to_id(pTouched);
 	META_RES res=MRES_IGNORED;
-	for (i=0; i<Touches.length(); i++)
+
+	if (Touches.length())
 	{
-		if (Touches[i]->Toucher.length() == 0)
+		// Every bucket that can match, walked together in registration order
+		TouchList *lists[4];
+		size_t pos[4];
+		size_t count = 0;
+		TouchClass *toucher;
+		TouchList *list;
+
+		if (TouchIndex.retrieve(ptrClass, &toucher))
 		{
-			if (Touches[i]->Touched.length() == 0)
+			if (toucher->Touched.retrieve(ptdClass, &list))
+				lists[count++] = list;
+
+			lists[count++] = &toucher->AnyTouched;
+		}
+
+		if (AnyToucher.Touched.elements() && AnyToucher.Touched.retrieve(ptdClass, &list))
+			lists[count++] = list;
+
+		lists[count++] = &AnyToucher.AnyTouched;
+
+		memset(pos, 0, sizeof(pos));
+
+		bool matched = false;
+
+		while (true)
+		{
+			Touch *next = NULL;
+			size_t from = 0;
+
+			for (size_t i = 0; i < count; i++)
 			{
-				retVal = MF_ExecuteForward(Touches[i]->Forward, (cell)ptrIndex, (cell)ptdIndex);
-				if (retVal & 2/*PLUGIN_HANDLED_MAIN*/)
-					RETURN_META(MRES_SUPERCEDE);
-				else if (retVal)
-					res=MRES_SUPERCEDE;
-			} else if (Touches[i]->Touched.compare(ptdClass)==0) {
-				retVal = MF_ExecuteForward(Touches[i]->Forward, (cell)ptrIndex, (cell)ptdIndex);
-				if (retVal & 2/*PLUGIN_HANDLED_MAIN*/)
-					RETURN_META(MRES_SUPERCEDE);
-				else if (retVal)
-					res=MRES_SUPERCEDE;
+				if (pos[i] < lists[i]->length())
+				{
+					Touch *p = lists[i]->at(pos[i]);
+					if (!next || p->Order < next->Order)
+					{
+						next = p;
+						from = i;
+					}
+				}
 			}
-		} else if (Touches[i]->Toucher.compare(ptrClass)==0) {
-			if (Touches[i]->Touched.length() == 0)
+
+			if (!next)
+				break;
+
+			pos[from]++;
+			matched = true;
+
+			retVal = MF_ExecuteForward(next->Forward, (cell)ptrIndex, (cell)ptdIndex);
+			if (retVal & 2/*PLUGIN_HANDLED_MAIN*/)
 			{
-				retVal = MF_ExecuteForward(Touches[i]->Forward, (cell)ptrIndex, (cell)ptdIndex);
-				if (retVal & 2/*PLUGIN_HANDLED_MAIN*/)
-					RETURN_META(MRES_SUPERCEDE);
-				else if (retVal)
-					res=MRES_SUPERCEDE;
-			} else if (Touches[i]->Touched.compare(ptdClass)==0) {
-				retVal = MF_ExecuteForward(Touches[i]->Forward, (cell)ptrIndex, (cell)ptdIndex);
-				if (retVal & 2/*PLUGIN_HANDLED_MAIN*/)
-					RETURN_META(MRES_SUPERCEDE);
-				else if (retVal)
-					res=MRES_SUPERCEDE;
+				TouchStats.executed++;
+				RETURN_META(MRES_SUPERCEDE);
 			}
+			else if (retVal)
+				res=MRES_SUPERCEDE;
 		}
+
+		if (matched)
+			TouchStats.executed++;
+		else
+			TouchStats.skipped++;
 	}
+
 	/* Execute pfnTouch forwards */
 	if (pfnTouchForward != -1) {
 		retVal = MF_ExecuteForward(pfnTouchForward, (cell)ptrIndex, (cell)ptdIndex);
@@ -302,21 +517,31 @@ void pfnTouch(edict_t *pToucher, edict_t *pTouched)
 
 void Think(edict_t *pent)
 {
-	unsigned int i = 0;
-	const char *cls = STRING(pent->v.classname);
 	META_RES res=MRES_IGNORED;
 	int retVal=0;
-	for (i=0; i<Thinks.length(); i++)
+	ThinkList *list;
+
+	if (Thinks.length())
 	{
-		if (Thinks[i]->Class.compare(cls)==0)
+		if (ThinkIndex.retrieve(STRING(pent->v.classname), &list) && list->length())
 		{
-			retVal=MF_ExecuteForward(Thinks[i]->Forward, (cell)TypeConversion.edict_to_id(pent));
-			if (retVal & 2/*PLUGIN_HANDLED_MAIN*/)
-				RETURN_META(MRES_SUPERCEDE);
-			else if (retVal)
-				res=MRES_SUPERCEDE;
+			ThinkStats.executed++;
+
+			for (size_t i = 0; i < list->length(); i++)
+			{
+				retVal=MF_ExecuteForward(list->at(i)->Forward, (cell)TypeConversion.edict_to_id(pent));
+				if (retVal & 2/*PLUGIN_HANDLED_MAIN*/)
+					RETURN_META(MRES_SUPERCEDE);
+				else if (retVal)
+					res=MRES_SUPERCEDE;
+			}
+		}
+		else
+		{
+			ThinkStats.skipped++;
 		}
 	}
+
 	retVal=MF_ExecuteForward(pfnThinkForward, (cell)TypeConversion.edict_to_id(pent));
 	if (retVal)
 		res=MRES_SUPERCEDE;
@@ -0,0 +1,486 @@
+// vim: set ts=4 sw=4 tw=99 noet:
+//
+// AMX Mod X, based on AMX Mod by Aleksander Naszko ("OLO").
+// Copyright (C) The AMX Mod X Development Team.
+//
+// This software is licensed under the GNU General Public License, version 3 or higher.
+// Additional exceptions apply. For full license details, see LICENSE.txt or visit:
+//     https://alliedmods.net/amxmodx-license
+
+//
+// Engine Module
+//
+
+// Checks the entity index behind find_ents_in_sphere/find_ents_by_class against
+// a plain scan of the edicts, then times both on a map with 900+ entities.
+//
+// The index only reads a handful of edict fields, so it runs against the small
+// fake engine below rather than the HLSDK.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <chrono>
+#include <amtl/am-vector.h>
+#include <amtl/am-string.h>
+#include <sm_stringhashmap.h>
+
+// stand-ins for the parts of engine.h that entindex.cpp uses
+#define _ENGINE_INCLUDE_H
+
+typedef int32_t cell;
+typedef int string_t;
+
+struct Vector
+{
+	Vector() : x(0.0f), y(0.0f), z(0.0f)
+	{
+	}
+
+	Vector(float vx, float vy, float vz) : x(vx), y(vy), z(vz)
+	{
+	}
+
+	float operator [](int i) const { return (&x)[i]; }
+
+	float x, y, z;
+};
+
+struct entvars_t
+{
+	string_t classname;
+	Vector absmin;
+	Vector absmax;
+};
+
+struct edict_t
+{
+	int free;
+	entvars_t v;
+};
+
+struct globalvars_t
+{
+	float time;
+	int maxClients;
+	int maxEntities;
+};
+
+#define TEST_MAX_ENTITIES	1380
+#define TEST_MAX_CLIENTS	32
+
+static edict_t Edicts[TEST_MAX_ENTITIES + 1];
+static bool PlayersIngame[TEST_MAX_CLIENTS + 1];
+static globalvars_t Globals = { 1.0f, TEST_MAX_CLIENTS, TEST_MAX_ENTITIES };
+static globalvars_t *gpGlobals = &Globals;
+
+// string_t are offsets in the engine's string pool, here indexes in this table
+static const char *Strings[] =
+{
+	"",
+	"player",
+	"func_wall",
+	"info_target",
+	"weaponbox",
+	"env_sprite",
+	"trigger_multiple",
+	"grenade",
+};
+
+#define TEST_CLASSNAMES (sizeof(Strings) / sizeof(Strings[0]))
+
+inline const char *STRING(string_t offset)
+{
+	return Strings[offset];
+}
+
+inline bool FNullEnt(const edict_t *pEdict)
+{
+	return pEdict == nullptr || pEdict == &Edicts[0];
+}
+
+inline bool MF_IsPlayerIngame(int index)
+{
+	return PlayersIngame[index];
+}
+
+struct
+{
+	edict_t *id_to_edict(int index) { return &Edicts[index]; }
+} TypeConversion;
+
+#include "../entindex.cpp"
+
+static uint32_t Seed = 2166136261u;
+
+static uint32_t Random()
+{
+	Seed = Seed * 1664525u + 1013904223u;
+	return Seed >> 8;
+}
+
+static float RandomFloat(float min, float max)
+{
+	return min + (max - min) * static_cast<float>(Random() & 0xFFFF) / 65535.0f;
+}
+
+static void PlaceEntity(int index, float x, float y, float z, float size)
+{
+	Edicts[index].v.absmin = Vector(x - size, y - size, z - size);
+	Edicts[index].v.absmax = Vector(x + size, y + size, z + size);
+}
+
+// Around 90% of the slots in use: players, small entities all over the map, a
+// few that cross the whole map and a few out of the grid bounds.
+static void BuildWorld()
+{
+	for (int i = 1; i <= TEST_MAX_ENTITIES; i++)
+	{
+		edict_t &ent = Edicts[i];
+
+		if (i <= TEST_MAX_CLIENTS)
+		{
+			ent.free = 0;
+			ent.v.classname = 1;
+			PlayersIngame[i] = (Random() % 4) != 0;
+			PlaceEntity(i, RandomFloat(-4000.0f, 4000.0f), RandomFloat(-4000.0f, 4000.0f), 0.0f, 16.0f);
+			continue;
+		}
+
+		ent.free = (Random() % 10) == 0;
+		ent.v.classname = ent.free ? 0 : 2 + Random() % (TEST_CLASSNAMES - 2);
+
+		const unsigned int kind = Random() % 100;
+		if (kind == 0)
+			PlaceEntity(i, 0.0f, 0.0f, 0.0f, 3000.0f);
+		else if (kind == 1)
+			PlaceEntity(i, RandomFloat(5000.0f, 8000.0f), RandomFloat(-8000.0f, -5000.0f), 0.0f, 32.0f);
+		else
+			PlaceEntity(i, RandomFloat(-4000.0f, 4000.0f), RandomFloat(-4000.0f, 4000.0f), RandomFloat(-500.0f, 500.0f), RandomFloat(4.0f, 200.0f));
+	}
+}
+
+static void NextFrame()
+{
+	Globals.time += 0.01f;
+}
+
+// What a plugin gets walking the edicts itself: in-game players and used
+// edicts with a classname, whose bounding box the sphere reaches.
+static bool ScanSearchable(int index)
+{
+	const edict_t &ent = Edicts[index];
+
+	if (ent.free || !ent.v.classname)
+		return false;
+
+	return index > TEST_MAX_CLIENTS || PlayersIngame[index];
+}
+
+static int ScanInSphere(const Vector &origin, float radius, const char *classname, cell *list, int max)
+{
+	int found = 0;
+
+	for (int i = 1; i <= TEST_MAX_ENTITIES && found < max; i++)
+	{
+		if (!ScanSearchable(i) || (*classname && strcmp(STRING(Edicts[i].v.classname), classname)))
+			continue;
+
+		const entvars_t &v = Edicts[i].v;
+		float distance = 0.0f;
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float delta = 0.0f;
+
+			if (origin[axis] < v.absmin[axis])
+				delta = origin[axis] - v.absmin[axis];
+			else if (origin[axis] > v.absmax[axis])
+				delta = origin[axis] - v.absmax[axis];
+
+			distance += delta * delta;
+		}
+
+		if (distance <= radius * radius)
+			list[found++] = i;
+	}
+
+	return found;
+}
+
+static int ScanByClass(const char *classname, cell *list, int max)
+{
+	int found = 0;
+
+	for (int i = 1; i <= TEST_MAX_ENTITIES && found < max; i++)
+	{
+		if (ScanSearchable(i) && !strcmp(STRING(Edicts[i].v.classname), classname))
+			list[found++] = i;
+	}
+
+	return found;
+}
+
+static int Failures;
+
+static void Check(bool condition, const char *what)
+{
+	if (!condition)
+	{
+		printf("FAIL: %s\n", what);
+		Failures++;
+	}
+}
+
+static bool SameList(const cell *a, int countA, const cell *b, int countB)
+{
+	return countA == countB && !memcmp(a, b, countA * sizeof(cell));
+}
+
+static bool Contains(const cell *list, int count, int index)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (list[i] == index)
+			return true;
+	}
+
+	return false;
+}
+
+static cell IndexList[TEST_MAX_ENTITIES];
+static cell ScanList[TEST_MAX_ENTITIES];
+
+static void TestMatchesScan()
+{
+	char what[128];
+	int queries = 0;
+
+	for (int frame = 0; frame < 40; frame++)
+	{
+		NextFrame();
+
+		// shuffle part of the world between frames, the index has to follow
+		for (int i = 0; i < 100; i++)
+		{
+			const int index = TEST_MAX_CLIENTS + 1 + Random() % (TEST_MAX_ENTITIES - TEST_MAX_CLIENTS);
+			Edicts[index].free = (Random() % 8) == 0;
+			Edicts[index].v.classname = Edicts[index].free ? 0 : 2 + Random() % (TEST_CLASSNAMES - 2);
+			PlaceEntity(index, RandomFloat(-4500.0f, 4500.0f), RandomFloat(-4500.0f, 4500.0f), 0.0f, RandomFloat(4.0f, 300.0f));
+		}
+
+		PlayersIngame[1 + Random() % TEST_MAX_CLIENTS] ^= true;
+
+		for (int q = 0; q < 50; q++, queries++)
+		{
+			const Vector origin(RandomFloat(-5000.0f, 5000.0f), RandomFloat(-5000.0f, 5000.0f), RandomFloat(-300.0f, 300.0f));
+			const float radius = (q % 5 == 0) ? RandomFloat(1000.0f, 6000.0f) : RandomFloat(0.0f, 600.0f);
+			const char *classname = (q % 3 == 0) ? "" : STRING(1 + Random() % (TEST_CLASSNAMES - 1));
+			const int max = (q % 7 == 0) ? 5 : TEST_MAX_ENTITIES;
+
+			const int found = g_EntityIndex.FindInSphere(origin, radius, classname, IndexList, max);
+			const int expected = ScanInSphere(origin, radius, classname, ScanList, max);
+
+			snprintf(what, sizeof(what), "in sphere, frame %d query %d (\"%s\", radius %.0f): %d vs %d", frame, q, classname, radius, found, expected);
+			Check(SameList(IndexList, found, ScanList, expected), what);
+		}
+
+		for (size_t c = 1; c < TEST_CLASSNAMES; c++, queries++)
+		{
+			const int found = g_EntityIndex.FindByClass(Strings[c], IndexList, TEST_MAX_ENTITIES);
+			const int expected = ScanByClass(Strings[c], ScanList, TEST_MAX_ENTITIES);
+
+			snprintf(what, sizeof(what), "by class, frame %d \"%s\": %d vs %d", frame, Strings[c], found, expected);
+			Check(SameList(IndexList, found, ScanList, expected), what);
+		}
+	}
+
+	Check(g_EntityIndex.FindByClass("no_such_class", IndexList, TEST_MAX_ENTITIES) == 0, "unknown classname");
+
+	printf("%d queries compared with the edict scan\n", queries);
+}
+
+// The index is refreshed once per frame: what changes later in the frame is
+// only partly seen until the next one. Entities may be missing, but an entity
+// is never reported once it is gone or no longer matches.
+static void TestSameFrameChanges()
+{
+	const Vector origin(1000.0f, 1000.0f, 0.0f);
+	const int created = TEST_MAX_ENTITIES - 1;
+	const int removed = TEST_MAX_ENTITIES - 2;
+	const int renamed = TEST_MAX_ENTITIES - 3;
+	const int moved = TEST_MAX_ENTITIES - 4;
+	int found;
+
+	NextFrame();
+
+	Edicts[created].free = 1;
+	Edicts[created].v.classname = 0;
+
+	Edicts[removed].free = 0;
+	Edicts[removed].v.classname = 3;
+	PlaceEntity(removed, origin.x, origin.y, 0.0f, 8.0f);
+
+	Edicts[renamed].free = 0;
+	Edicts[renamed].v.classname = 3;
+	PlaceEntity(renamed, origin.x, origin.y, 0.0f, 8.0f);
+
+	Edicts[moved].free = 0;
+	Edicts[moved].v.classname = 3;
+	PlaceEntity(moved, -3000.0f, -3000.0f, 0.0f, 8.0f);
+
+	found = g_EntityIndex.FindInSphere(origin, 64.0f, "info_target", IndexList, TEST_MAX_ENTITIES);
+	Check(Contains(IndexList, found, removed) && Contains(IndexList, found, renamed), "entities seen on the refresh");
+
+	// same frame: one entity spawns, one is removed, one is renamed, one moves
+	Edicts[created].free = 0;
+	Edicts[created].v.classname = 3;
+	PlaceEntity(created, origin.x, origin.y, 0.0f, 8.0f);
+
+	Edicts[removed].free = 1;
+	Edicts[removed].v.classname = 0;
+
+	Edicts[renamed].v.classname = 4;
+
+	PlaceEntity(moved, origin.x, origin.y, 0.0f, 8.0f);
+
+	found = g_EntityIndex.FindInSphere(origin, 64.0f, "info_target", IndexList, TEST_MAX_ENTITIES);
+	Check(!Contains(IndexList, found, created), "created this frame, not in the index until the next frame");
+	Check(!Contains(IndexList, found, removed), "removed this frame, not reported");
+	Check(!Contains(IndexList, found, renamed), "renamed this frame, not reported under its old classname");
+
+	found = g_EntityIndex.FindByClass("info_target", IndexList, TEST_MAX_ENTITIES);
+	Check(!Contains(IndexList, found, created), "created this frame, not in the classname index until the next frame");
+	Check(!Contains(IndexList, found, removed) && !Contains(IndexList, found, renamed), "removed or renamed this frame, not reported by class");
+
+	found = g_EntityIndex.FindByClass("weaponbox", IndexList, TEST_MAX_ENTITIES);
+	Check(!Contains(IndexList, found, renamed), "renamed this frame, not under its new classname until the next frame");
+
+	// whatever the index reports this frame is also in the scan
+	found = g_EntityIndex.FindInSphere(origin, 2000.0f, "", IndexList, TEST_MAX_ENTITIES);
+	const int expected = ScanInSphere(origin, 2000.0f, "", ScanList, TEST_MAX_ENTITIES);
+
+	for (int i = 0; i < found; i++)
+	{
+		if (!Contains(ScanList, expected, IndexList[i]))
+		{
+			Check(false, "reported an entity the scan doesn't see");
+			break;
+		}
+	}
+
+	NextFrame();
+
+	found = g_EntityIndex.FindInSphere(origin, 64.0f, "info_target", IndexList, TEST_MAX_ENTITIES);
+	Check(Contains(IndexList, found, created) && Contains(IndexList, found, moved), "created and moved entities found on the next frame");
+
+	found = g_EntityIndex.FindByClass("weaponbox", IndexList, TEST_MAX_ENTITIES);
+	Check(Contains(IndexList, found, renamed), "renamed entity found under its new classname on the next frame");
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static double Elapsed(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// Queries per frame as a plugin would run them, the index pays its refresh
+// once per frame
+static void Benchmark(const char *label, int frames, int queriesPerFrame, float radius, const char *classname)
+{
+	const int total = frames * queriesPerFrame;
+	Vector *origins = new Vector[total];
+	long found = 0;
+	int i;
+
+	for (i = 0; i < total; i++)
+	{
+		origins[i] = Vector(RandomFloat(-4000.0f, 4000.0f), RandomFloat(-4000.0f, 4000.0f), 0.0f);
+	}
+
+	Clock::time_point start = Clock::now();
+	for (i = 0; i < total; i++)
+	{
+		found += ScanInSphere(origins[i], radius, classname, ScanList, TEST_MAX_ENTITIES);
+	}
+	const double scan = Elapsed(start);
+
+	start = Clock::now();
+	for (i = 0; i < total; i++)
+	{
+		if (i % queriesPerFrame == 0)
+			NextFrame();
+
+		found -= g_EntityIndex.FindInSphere(origins[i], radius, classname, IndexList, TEST_MAX_ENTITIES);
+	}
+	const double grid = Elapsed(start);
+
+	printf("%-34s scan %8.2f us  index %8.2f us  (%.1fx)\n", label, scan / total, grid / total, scan / grid);
+	Check(found == 0, "benchmark results differ");
+
+	delete [] origins;
+}
+
+static void BenchmarkByClass(int frames, int queriesPerFrame)
+{
+	const int total = frames * queriesPerFrame;
+	long found = 0;
+	int i;
+
+	Clock::time_point start = Clock::now();
+	for (i = 0; i < total; i++)
+	{
+		found += ScanByClass(Strings[2 + i % (TEST_CLASSNAMES - 2)], ScanList, TEST_MAX_ENTITIES);
+	}
+	const double scan = Elapsed(start);
+
+	start = Clock::now();
+	for (i = 0; i < total; i++)
+	{
+		if (i % queriesPerFrame == 0)
+			NextFrame();
+
+		found -= g_EntityIndex.FindByClass(Strings[2 + i % (TEST_CLASSNAMES - 2)], IndexList, TEST_MAX_ENTITIES);
+	}
+	const double index = Elapsed(start);
+
+	printf("%-34s scan %8.2f us  index %8.2f us  (%.1fx)\n", "by class, 16 per frame", scan / total, index / total, scan / index);
+	Check(found == 0, "benchmark results differ");
+}
+
+int main()
+{
+	BuildWorld();
+
+	int used = 0;
+	for (int i = 1; i <= TEST_MAX_ENTITIES; i++)
+	{
+		if (ScanSearchable(i))
+			used++;
+	}
+
+	printf("%d searchable entities out of %d edicts\n", used, TEST_MAX_ENTITIES);
+
+	TestMatchesScan();
+	TestSameFrameChanges();
+
+	BuildWorld();
+	Benchmark("radius 300, 1 per frame", 2000, 1, 300.0f, "");
+	Benchmark("radius 300, 16 per frame", 200, 16, 300.0f, "");
+	Benchmark("radius 300 by class, 16 per frame", 200, 16, 300.0f, "weaponbox");
+	Benchmark("radius 1500, 16 per frame", 200, 16, 1500.0f, "");
+	BenchmarkByClass(200, 16);
+
+	g_EntityIndex.Clear();
+
+	if (Failures)
+	{
+		printf("%d check(s) failed\n", Failures);
+		return 1;
+	}
+
+	printf("all checks passed\n");
+	return 0;
+}
@@ -12,6 +12,7 @@
 //
 
 #include "fakemeta_amxx.h"
+#include "pdata_shared.h"
 #include "sh_stack.h"
 #include <resdk/mod_regamedll_api.h>
 
@@ -107,6 +108,9 @@ void OnAmxxDetach()
 	ConfigManager->CloseGameConfigFile(CommonConfig);
 	ConfigManager->CloseGameConfigFile(GamerulesConfig);
 
+	MemberLookupCache.Clear();
+	MemberHandles.clear();
+
 	if (HasRegameDll)
 	{
 		ReGameHookchains->InstallGameRules()->unregisterHook(InstallGameRules);
@@ -14,6 +14,70 @@
 #include "fakemeta_amxx.h"
 #include "pdata_shared.h"
 
+MemberCache MemberLookupCache;
+ke::Vector<MemberHandle> MemberHandles;
+
+static bool SameString(const cell *string, const char *value)
+{
+	while (*string == static_cast<unsigned char>(*value))
+	{
+		if (!*value)
+			return true;
+
+		string++;
+		value++;
+	}
+
+	return false;
+}
+
+size_t MemberCache::Slot(AMX *amx, cell classAddr, cell memberAddr)
+{
+	size_t hash = reinterpret_cast<uintptr_t>(amx) >> 4;
+
+	hash = hash * 31 + static_cast<size_t>(classAddr);
+	hash = hash * 31 + static_cast<size_t>(memberAddr);
+
+	return (hash ^ (hash >> 8)) & (MEMBER_CACHE_SIZE - 1);
+}
+
+const char *MemberCache::Find(AMX *amx, IGameConfig *conf, cell classAddr, cell memberAddr, TypeDescription &data)
+{
+	Entry &entry = m_Entries[Slot(amx, classAddr, memberAddr)];
+
+	if (entry.amx != amx || entry.conf != conf || entry.classAddr != classAddr || entry.memberAddr != memberAddr)
+		return nullptr;
+
+	if (!SameString(MF_GetAmxAddr(amx, classAddr), entry.className.chars()) ||
+		!SameString(MF_GetAmxAddr(amx, memberAddr), entry.memberName.chars()))
+		return nullptr;
+
+	data = entry.data;
+	return entry.memberName.chars();
+}
+
+void MemberCache::Add(AMX *amx, IGameConfig *conf, cell classAddr, cell memberAddr, const char *className, const char *memberName, const TypeDescription &data)
+{
+	Entry &entry = m_Entries[Slot(amx, classAddr, memberAddr)];
+
+	entry.amx = amx;
+	entry.conf = conf;
+	entry.classAddr = classAddr;
+	entry.memberAddr = memberAddr;
+	entry.className = className;
+	entry.memberName = memberName;
+	entry.data = data;
+}
+
+void MemberCache::Clear()
+{
+	for (size_t i = 0; i < MEMBER_CACHE_SIZE; i++)
+	{
+		m_Entries[i].amx = nullptr;
+		m_Entries[i].conf = nullptr;
+	}
+}
+
 // native any:get_ent_data(entity, const class[], const member[], element = 0);
 static cell AMX_NATIVE_CALL get_ent_data(AMX *amx, cell *params)
 {
@@ -228,19 +292,244 @@ static cell AMX_NATIVE_CALL find_ent_data_info(AMX *amx, cell *params)
 }
 
 
+// native EntMember:find_ent_member(const class[], const member[]);
+static cell AMX_NATIVE_CALL find_ent_member(AMX *amx, cell *params)
+{
+	TypeDescription data;
+	GET_TYPE_DESCRIPTION(1, data, CommonConfig);
+
+	int length;
+	const char *className = MF_GetAmxString(amx, params[1], 0, &length);
+
+	for (size_t i = 0; i < MemberHandles.length(); ++i)
+	{
+		if (!strcmp(MemberHandles[i].className.chars(), className) && !strcmp(MemberHandles[i].memberName.chars(), memberName))
+		{
+			return static_cast<cell>(i + 1);
+		}
+	}
+
+	MemberHandle handle;
+	handle.className = className;
+	handle.memberName = memberName;
+	handle.data = data;
+
+	MemberHandles.append(handle);
+
+	return static_cast<cell>(MemberHandles.length());
+}
+
+// native any:get_ent_member(entity, EntMember:member, element = 0);
+static cell AMX_NATIVE_CALL get_ent_member(AMX *amx, cell *params)
+{
+	int entity = params[1];
+	CHECK_ENTITY_PDATA(entity);
+
+	TypeDescription data;
+	GET_MEMBER_HANDLE(2, data);
+
+	int element = params[3];
+	CHECK_DATA(data, element, BaseFieldType::Integer);
+
+	return PvData::GetInt(entity, data, element);
+}
+
+// native set_ent_member(entity, EntMember:member, any:value, element = 0);
+static cell AMX_NATIVE_CALL set_ent_member(AMX *amx, cell *params)
+{
+	int entity = params[1];
+	CHECK_ENTITY_PDATA(entity);
+
+	TypeDescription data;
+	GET_MEMBER_HANDLE(2, data);
+
+	int element = params[4];
+	CHECK_DATA(data, element, BaseFieldType::Integer);
+
+	if (data.fieldType == FieldType::FIELD_STRUCTURE || data.fieldType == FieldType::FIELD_CLASS)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Setting directly to a class or structure address is not available");
+		return 0;
+	}
+
+	PvData::SetInt(entity, data, params[3], element);
+
+	return 1;
+}
+
+// native Float:get_ent_member_float(entity, EntMember:member, element = 0);
+static cell AMX_NATIVE_CALL get_ent_member_float(AMX *amx, cell *params)
+{
+	int entity = params[1];
+	CHECK_ENTITY_PDATA(entity);
+
+	TypeDescription data;
+	GET_MEMBER_HANDLE(2, data);
+
+	int element = params[3];
+	CHECK_DATA(data, element, BaseFieldType::Float);
+
+	return PvData::GetFloat(entity, data, element);
+}
+
+// native set_ent_member_float(entity, EntMember:member, Float:value, element = 0);
+static cell AMX_NATIVE_CALL set_ent_member_float(AMX *amx, cell *params)
+{
+	int entity = params[1];
+	CHECK_ENTITY_PDATA(entity);
+
+	TypeDescription data;
+	GET_MEMBER_HANDLE(2, data);
+
+	int element = params[4];
+	CHECK_DATA(data, element, BaseFieldType::Float);
+
+	PvData::SetFloat(entity, data, amx_ctof(params[3]), element);
+
+	return 1;
+}
+
+// native get_ent_member_vector(entity, EntMember:member, Float:value[3], element = 0);
+static cell AMX_NATIVE_CALL get_ent_member_vector(AMX *amx, cell *params)
+{
+	int entity = params[1];
+	CHECK_ENTITY_PDATA(entity);
+
+	TypeDescription data;
+	GET_MEMBER_HANDLE(2, data);
+
+	int element = params[4];
+	CHECK_DATA(data, element, BaseFieldType::Vector);
+
+	PvData::GetVector(entity, data, MF_GetAmxAddr(amx, params[3]), element);
+
+	return 1;
+}
+
+// native set_ent_member_vector(entity, EntMember:member, Float:value[3], element = 0);
+static cell AMX_NATIVE_CALL set_ent_member_vector(AMX *amx, cell *params)
+{
+	int entity = params[1];
+	CHECK_ENTITY_PDATA(entity);
+
+	TypeDescription data;
+	GET_MEMBER_HANDLE(2, data);
+
+	int element = params[4];
+	CHECK_DATA(data, element, BaseFieldType::Vector);
+
+	PvData::SetVector(entity, data, MF_GetAmxAddr(amx, params[3]), element);
+
+	return 1;
+}
+
+// native get_ent_member_entity(entity, EntMember:member, element = 0);
+static cell AMX_NATIVE_CALL get_ent_member_entity(AMX *amx, cell *params)
+{
+	int entity = params[1];
+	CHECK_ENTITY_PDATA(entity);
+
+	TypeDescription data;
+	GET_MEMBER_HANDLE(2, data);
+
+	int element = params[3];
+	CHECK_DATA(data, element, BaseFieldType::Entity);
+
+	return PvData::GetEntity(entity, data, element);
+}
+
+// native set_ent_member_entity(entity, EntMember:member, value, element = 0);
+static cell AMX_NATIVE_CALL set_ent_member_entity(AMX *amx, cell *params)
+{
+	int entity = params[1];
+	int value = params[3];
+
+	CHECK_ENTITY_PDATA(entity);
+
+	if (value != -1)
+	{
+		CHECK_ENTITY(value);
+	}
+
+	TypeDescription data;
+	GET_MEMBER_HANDLE(2, data);
+
+	int element = params[4];
+	CHECK_DATA(data, element, BaseFieldType::Entity);
+
+	PvData::SetEntity(entity, data, value, element);
+
+	return 1;
+}
+
+// native get_ent_member_string(entity, EntMember:member, value[], maxlen, element = 0);
+static cell AMX_NATIVE_CALL get_ent_member_string(AMX *amx, cell *params)
+{
+	int entity = params[1];
+	CHECK_ENTITY_PDATA(entity);
+
+	TypeDescription data;
+	GET_MEMBER_HANDLE(2, data);
+
+	int element = params[5];
+	CHECK_DATA(data, element, BaseFieldType::String);
+
+	auto buffer = params[3];
+	auto maxlen = params[4];
+
+	auto string = PvData::GetString(entity, data, element);
+
+	if (data.fieldSize)
+	{
+		maxlen = ke::Min(maxlen, data.fieldSize);
+	}
+
+	return MF_SetAmxStringUTF8Char(amx, buffer, string ? string : "", string ? strlen(string) : 0, maxlen);
+}
+
+// native set_ent_member_string(entity, EntMember:member, const value[], element = 0);
+static cell AMX_NATIVE_CALL set_ent_member_string(AMX *amx, cell *params)
+{
+	int entity = params[1];
+	CHECK_ENTITY_PDATA(entity);
+
+	TypeDescription data;
+	GET_MEMBER_HANDLE(2, data);
+
+	int element = params[4];
+	CHECK_DATA(data, element, BaseFieldType::String);
+
+	int length;
+	const char *value = MF_GetAmxString(amx, params[3], 0, &length);
+
+	return PvData::SetString(entity, data, value, length, element);
+}
+
+
 AMX_NATIVE_INFO pdata_entities_natives[] =
 {
-	{ "get_ent_data"        , get_ent_data         },
-	{ "set_ent_data"        , set_ent_data         },
-	{ "get_ent_data_float"  , get_ent_data_float   },
-	{ "set_ent_data_float"  , set_ent_data_float   },
-	{ "get_ent_data_vector" , get_ent_data_vector  },
-	{ "set_ent_data_vector" , set_ent_data_vector  },
-	{ "get_ent_data_entity" , get_ent_data_entity  },
-	{ "set_ent_data_entity" , set_ent_data_entity  },
-	{ "get_ent_data_string" , get_ent_data_string  },
-	{ "set_ent_data_string" , set_ent_data_string  },
-	{ "get_ent_data_size"   , get_ent_data_size    },
-	{ "find_ent_data_info"  , find_ent_data_info   },
-	{ nullptr               , nullptr              }
+	{ "get_ent_data"          , get_ent_data           },
+	{ "set_ent_data"          , set_ent_data           },
+	{ "get_ent_data_float"    , get_ent_data_float     },
+	{ "set_ent_data_float"    , set_ent_data_float     },
+	{ "get_ent_data_vector"   , get_ent_data_vector    },
+	{ "set_ent_data_vector"   , set_ent_data_vector    },
+	{ "get_ent_data_entity"   , get_ent_data_entity    },
+	{ "set_ent_data_entity"   , set_ent_data_entity    },
+	{ "get_ent_data_string"   , get_ent_data_string    },
+	{ "set_ent_data_string"   , set_ent_data_string    },
+	{ "get_ent_data_size"     , get_ent_data_size      },
+	{ "find_ent_data_info"    , find_ent_data_info     },
+	{ "find_ent_member"       , find_ent_member        },
+	{ "get_ent_member"        , get_ent_member         },
+	{ "set_ent_member"        , set_ent_member         },
+	{ "get_ent_member_float"  , get_ent_member_float   },
+	{ "set_ent_member_float"  , set_ent_member_float   },
+	{ "get_ent_member_vector" , get_ent_member_vector  },
+	{ "set_ent_member_vector" , set_ent_member_vector  },
+	{ "get_ent_member_entity" , get_ent_member_entity  },
+	{ "set_ent_member_entity" , set_ent_member_entity  },
+	{ "get_ent_member_string" , get_ent_member_string  },
+	{ "set_ent_member_string" , set_ent_member_string  },
+	{ nullptr                 , nullptr                }
 };
\ No newline at end of file
@@ -13,6 +13,8 @@
 #include <IGameConfigs.h>
 #include <HLTypeConversion.h>
 #include <amtl/am-algorithm.h>
+#include <amtl/am-string.h>
+#include <amtl/am-vector.h>
 
 extern HLTypeConversion TypeConversion;
 
@@ -26,26 +28,87 @@ enum class BaseFieldType
 	String,
 };
 
+// Class and member strings last seen at a plugin address, so calls made over and
+// over with the same literals skip copying them and the gamedata lookups. An entry
+// is only used once the strings at the address are checked to be the same, as it
+// may as well be an array the plugin changes.
+#define MEMBER_CACHE_SIZE 256
+
+class MemberCache
+{
+public:
+	// Returns the member name, or nullptr if the strings have to be looked up
+	const char *Find(AMX *amx, IGameConfig *conf, cell classAddr, cell memberAddr, TypeDescription &data);
+	void Add(AMX *amx, IGameConfig *conf, cell classAddr, cell memberAddr, const char *className, const char *memberName, const TypeDescription &data);
+	void Clear();
+
+private:
+	struct Entry
+	{
+		Entry() : amx(nullptr), conf(nullptr)
+		{
+		}
+
+		AMX *amx;
+		IGameConfig *conf;
+		cell classAddr;
+		cell memberAddr;
+		ke::AString className;
+		ke::AString memberName;
+		TypeDescription data;
+	};
+
+	static size_t Slot(AMX *amx, cell classAddr, cell memberAddr);
+
+	Entry m_Entries[MEMBER_CACHE_SIZE];
+};
+
+// Members resolved once with find_ent_member(), handles are indexes into the list plus one
+struct MemberHandle
+{
+	ke::AString className;
+	ke::AString memberName;
+	TypeDescription data;
+};
+
+extern MemberCache MemberLookupCache;
+extern ke::Vector<MemberHandle> MemberHandles;
+
 #define GET_TYPE_DESCRIPTION(position, data, conf)                                         \
-	int classLength, memberLength;                                                         \
-	char const *className = MF_GetAmxString(amx, params[position], 0, &classLength);       \
-	char const *memberName = MF_GetAmxString(amx, params[position + 1], 1, &memberLength); \
-	if (!classLength || !memberLength)                                                     \
-	{                                                                                      \
-		MF_LogError(amx, AMX_ERR_NATIVE, "Either class (\"%s\") or member (\"%s\") is empty", className, memberName); \
-		return 0;                                                                          \
-	}                                                                                      \
-	else if (!conf->GetOffsetByClass(className, memberName, &data))                        \
-	{                                                                                      \
-		MF_LogError(amx, AMX_ERR_NATIVE, "Could not find class \"%s\" and/or member \"%s\" in gamedata", className, memberName); \
-		return 0;                                                                          \
-	}                                                                                      \
-	else if (data.fieldOffset < 0)                                                         \
+	char const *memberName = MemberLookupCache.Find(amx, conf, params[position], params[position + 1], data); \
+	if (!memberName)                                                                       \
 	{                                                                                      \
+		int classLength, memberLength;                                                     \
+		char const *className = MF_GetAmxString(amx, params[position], 0, &classLength);   \
+		memberName = MF_GetAmxString(amx, params[position + 1], 1, &memberLength);         \
+		if (!classLength || !memberLength)                                                 \
+		{                                                                                  \
+			MF_LogError(amx, AMX_ERR_NATIVE, "Either class (\"%s\") or member (\"%s\") is empty", className, memberName); \
+			return 0;                                                                      \
+		}                                                                                  \
+		else if (!conf->GetOffsetByClass(className, memberName, &data))                    \
+		{                                                                                  \
+			MF_LogError(amx, AMX_ERR_NATIVE, "Could not find class \"%s\" and/or member \"%s\" in gamedata", className, memberName); \
+			return 0;                                                                      \
+		}                                                                                  \
+		else if (data.fieldOffset < 0)                                                     \
+		{                                                                                  \
 			MF_LogError(amx, AMX_ERR_NATIVE, "Invalid offset %d retrieved from \"%s\" member", data.fieldOffset, memberName); \
 			return 0;                                                                      \
+		}                                                                                  \
+		MemberLookupCache.Add(amx, conf, params[position], params[position + 1], className, memberName, data); \
 	}
 
+#define GET_MEMBER_HANDLE(position, data)                                                  \
+	size_t handleIndex = static_cast<size_t>(params[position]) - 1;                        \
+	if (handleIndex >= MemberHandles.length())                                             \
+	{                                                                                      \
+		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid member handle %d", params[position]);    \
+		return 0;                                                                          \
+	}                                                                                      \
+	data = MemberHandles[handleIndex].data;                                                \
+	char const *memberName = MemberHandles[handleIndex].memberName.chars();
+
 #define CHECK_DATA(data, element, baseType)                                                \
 	if (baseType > BaseFieldType::None && baseType != PvData::GetBaseDataType(data))       \
 	{                                                                                      \
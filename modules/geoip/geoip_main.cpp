@@ -34,11 +34,26 @@ void OnAmxxAttach()
 
 void OnAmxxDetach()
 {
+	clearLookupCache();
 	MMDB_close(&HandleDB);
 
 	LangList.clear();
 }
 
+BOOL ClientConnect_Post(edict_t *pEntity, const char *pszName, const char *pszAddress, char szRejectReason[128])
+{
+	// Resolve the usual fields now, plugins will ask for them right away.
+	if (NativesRegistered && pszAddress)
+	{
+		char ip[64];
+		ke::SafeSprintf(ip, sizeof(ip), "%s", pszAddress);
+
+		prefetchIp(stripPort(ip));
+	}
+
+	RETURN_META_VALUE(MRES_IGNORED, TRUE);
+}
+
 void OnGeoipCommand()
 {
 	const auto cmd = CMD_ARGV(1);
@@ -165,6 +180,7 @@ void OnGeoipCommand()
 
 		if (isDatabaseLoaded)
 		{
+			clearLookupCache();
 			MMDB_close(&HandleDB);
 		}
 
@@ -14,6 +14,7 @@
 #include "geoip_util.h"
 #include "geoip_natives.h"
 #include <amtl/am-algorithm.h>
+#include <sm_stringhashmap.h>
 
 const char GeoIPCountryCode[252][3] =
 {
@@ -114,18 +115,70 @@ const char* stristr(const char* str, const char* substr)
 	return NULL;
 }
 
-bool lookupByIp(const char *ip, const char **path, MMDB_entry_data_s *result)
+// Lookups are cached per IP, plugins tend to ask several fields for the same
+// player, on connect and then over and over from scoreboards. Data pointers in
+// cached results point into the mapped database, so the cache must be cleared
+// whenever the database is closed.
+
+#define GEOIP_CACHE_SIZE 256
+
+struct CachedValue
 {
-	int gai_error = 0, mmdb_error = 0;
-	MMDB_lookup_result_s lookup = MMDB_lookup_string(&HandleDB, ip, &gai_error, &mmdb_error);
+	ke::AString path;
+	bool found;
+	MMDB_entry_data_s data;
+};
+
+struct CachedLookup
+{
+	bool found;
+	MMDB_entry_s entry;
+	ke::Vector<CachedValue> values;
+};
 
-	if (gai_error != 0 || mmdb_error != MMDB_SUCCESS || !lookup.found_entry)
+static StringHashMap<CachedLookup *> LookupCache;
+
+void clearLookupCache()
+{
+	for (StringHashMap<CachedLookup *>::iterator iter = LookupCache.iter(); !iter.empty(); iter.next())
 	{
-		return false;
+		delete (*iter).value;
+	}
+
+	LookupCache.clear();
+}
+
+static CachedLookup *getLookup(const char *ip)
+{
+	CachedLookup *lookup;
+
+	if (LookupCache.retrieve(ip, &lookup))
+	{
+		return lookup;
+	}
+
+	// Players come and go, don't bother with anything smarter than a reset.
+	if (LookupCache.elements() >= GEOIP_CACHE_SIZE)
+	{
+		clearLookupCache();
 	}
 
+	int gai_error = 0, mmdb_error = 0;
+	MMDB_lookup_result_s result = MMDB_lookup_string(&HandleDB, ip, &gai_error, &mmdb_error);
+
+	lookup = new CachedLookup;
+	lookup->found = gai_error == 0 && mmdb_error == MMDB_SUCCESS && result.found_entry;
+	lookup->entry = result.entry;
+
+	LookupCache.insert(ip, lookup);
+
+	return lookup;
+}
+
+static bool lookupEntry(MMDB_entry_s *entry, const char **path, MMDB_entry_data_s *result)
+{
 	MMDB_entry_data_s entry_data;
-	MMDB_aget_value(&lookup.entry, &entry_data, path);
+	MMDB_aget_value(entry, &entry_data, path);
 
 	if (!entry_data.has_data)
 	{
@@ -146,8 +199,7 @@ bool lookupByIp(const char *ip, const char **path, MMDB_entry_data_s *result)
 		path[i] = "en";
 
 		// Try again.
-		gai_error = mmdb_error = 0;
-		MMDB_aget_value(&lookup.entry, &entry_data, path);
+		MMDB_aget_value(entry, &entry_data, path);
 
 		if (!entry_data.has_data)
 		{
@@ -160,6 +212,73 @@ bool lookupByIp(const char *ip, const char **path, MMDB_entry_data_s *result)
 	return true;
 }
 
+bool lookupByIp(const char *ip, const char **path, MMDB_entry_data_s *result)
+{
+	CachedLookup *lookup = getLookup(ip);
+
+	if (!lookup->found)
+	{
+		return false;
+	}
+
+	char key[128];
+	size_t length = 0;
+
+	for (size_t i = 0; path[i] && length < sizeof(key) - 1; ++i)
+	{
+		length += ke::SafeSprintf(key + length, sizeof(key) - length, "%s/", path[i]);
+	}
+
+	key[length] = '\0';
+
+	for (size_t i = 0; i < lookup->values.length(); ++i)
+	{
+		CachedValue &value = lookup->values[i];
+
+		if (!value.path.compare(key))
+		{
+			*result = value.data;
+			return value.found;
+		}
+	}
+
+	CachedValue value;
+	value.path = key;
+	value.found = lookupEntry(&lookup->entry, path, &value.data);
+
+	if (value.found)
+	{
+		*result = value.data;
+	}
+
+	lookup->values.append(value);
+
+	return value.found;
+}
+
+void prefetchIp(const char *ip)
+{
+	if (!HandleDB.filename || !getLookup(ip)->found)
+	{
+		return;
+	}
+
+	MMDB_entry_data_s result;
+	const char *lang = getLang(0);
+
+	const char *code[] = { "country", "iso_code", NULL };
+	const char *continent[] = { "continent", "code", NULL };
+	const char *country[] = { "country", "names", lang, NULL };
+	const char *city[] = { "city", "names", lang, NULL };
+	const char *continentName[] = { "continent", "names", lang, NULL };
+
+	lookupByIp(ip, code, &result);
+	lookupByIp(ip, continent, &result);
+	lookupByIp(ip, country, &result);
+	lookupByIp(ip, city, &result);
+	lookupByIp(ip, continentName, &result);
+}
+
 const char *lookupString(const char *ip, const char **path, int *length)
 {
 	static char buffer[256]; // This should be large enough for long name in UTF-8.
@@ -19,6 +19,8 @@
 char *stripPort(char *ip);
 
 bool lookupByIp(const char *ip, const char **path, MMDB_entry_data_s *result);
+void prefetchIp(const char *ip);
+void clearLookupCache();
 double lookupDouble(const char *ip, const char **path);
 const char *lookupString(const char *ip, const char **path, int *length = NULL);
 
@@ -163,7 +163,7 @@
 // #define FN_SaveGlobalState_Post				SaveGlobalState_Post
 // #define FN_RestoreGlobalState_Post			RestoreGlobalState_Post
 // #define FN_ResetGlobalState_Post				ResetGlobalState_Post
-// #define FN_ClientConnect_Post				ClientConnect_Post
+#define FN_ClientConnect_Post				ClientConnect_Post
 // #define FN_ClientDisconnect_Post				ClientDisconnect_Post
 // #define FN_ClientKill_Post					ClientKill_Post
 // #define FN_ClientPutInServer_Post			ClientPutInServer_Post
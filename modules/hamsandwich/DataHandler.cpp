@@ -23,7 +23,7 @@
 
 CStack< Data * > ReturnStack;
 CStack< Data * > OrigReturnStack;
-CStack< ke::Vector< Data * > * > ParamStack;
+CStack< ParamFrame * > ParamStack;
 CStack< int * > ReturnStatus;
 #define CHECK_STACK(__STACK__)								\
 	if (  ( __STACK__ ).size() <= 0)						\
@@ -179,7 +179,7 @@ static cell AMX_NATIVE_CALL SetHamReturnString(AMX *amx, cell *params)
 static cell AMX_NATIVE_CALL SetHamParamInteger(AMX *amx, cell *params)
 {
 	CHECK_STACK(ParamStack);
-	ke::Vector<Data *> *vec = ParamStack.front();
+	ParamFrame *vec = ParamStack.front();
 	if (vec->length() < (unsigned)params[1]) 
 	{ 
 		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid parameter number, got %d, expected %d", params[1], vec->length()); 
@@ -199,7 +199,7 @@ static cell AMX_NATIVE_CALL SetHamParamTraceResult(AMX *amx, cell *params)
 		return 0;
 	}
 	CHECK_STACK(ParamStack);
-	ke::Vector<Data *> *vec = ParamStack.front();
+	ParamFrame *vec = ParamStack.front();
 	if (vec->length() < (unsigned)params[1]) 
 	{ 
 		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid parameter number, got %d, expected %d", params[1], vec->length()); 
@@ -213,7 +213,7 @@ static cell AMX_NATIVE_CALL SetHamParamTraceResult(AMX *amx, cell *params)
 static cell AMX_NATIVE_CALL SetHamParamFloat(AMX *amx, cell *params)
 {
 	CHECK_STACK(ParamStack);
-	ke::Vector<Data *> *vec = ParamStack.front();
+	ParamFrame *vec = ParamStack.front();
 	if (vec->length() < (unsigned)params[1] || params[1] < 1) 
 	{ 
 		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid parameter number, got %d, expected %d", params[1], vec->length()); 
@@ -227,7 +227,7 @@ static cell AMX_NATIVE_CALL SetHamParamFloat(AMX *amx, cell *params)
 static cell AMX_NATIVE_CALL SetHamParamVector(AMX *amx, cell *params)
 {
 	CHECK_STACK(ParamStack);
-	ke::Vector<Data *> *vec = ParamStack.front();
+	ParamFrame *vec = ParamStack.front();
 	if (vec->length() < (unsigned)params[1]) 
 	{ 
 		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid parameter number, got %d, expected %d", params[1], vec->length()); 
@@ -242,7 +242,7 @@ static cell AMX_NATIVE_CALL SetHamParamVector(AMX *amx, cell *params)
 cell SetParamEntity(AMX *amx, cell *params, bool updateIndex)
 {
 	CHECK_STACK(ParamStack);
-	ke::Vector<Data *> *vec = ParamStack.front();
+	ParamFrame *vec = ParamStack.front();
 	if (vec->length() < (unsigned)params[1])
 	{
 		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid parameter number, got %d, expected %d", params[1], vec->length());
@@ -267,7 +267,7 @@ static cell AMX_NATIVE_CALL SetHamParamEntity2(AMX *amx, cell *params)
 static cell AMX_NATIVE_CALL SetHamParamString(AMX *amx, cell *params)
 {
 	CHECK_STACK(ParamStack);
-	ke::Vector<Data *> *vec=ParamStack.front(); 
+	ParamFrame *vec=ParamStack.front(); 
 	if (vec->length() < (unsigned)params[1]) 
 	{ 
 		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid parameter number, got %d, expected %d", params[1], vec->length()); 
@@ -288,7 +288,7 @@ static cell AMX_NATIVE_CALL SetHamParamItemInfo(AMX *amx, cell *params)
 	}
 
 	CHECK_STACK(ParamStack);
-	ke::Vector<Data *> *vec = ParamStack.front();
+	ParamFrame *vec = ParamStack.front();
 
 	if (vec->length() < (unsigned)params[1])
 	{
@@ -367,8 +367,42 @@ public:
 	}
 };
 
+// Most parameters a hook passes, "this" included
+#define HAM_MAX_PARAMS 10
+
+// Parameters of the hooked call in execution.
+// Lives on the stack of the hook callback, so a call never allocates.
+class ParamFrame
+{
+private:
+	Data	m_params[HAM_MAX_PARAMS];
+	size_t	m_count;
+
+public:
+	ParamFrame() : m_count(0)
+	{ /* nothing */ };
+
+	inline void append(int type, void *ptr, int *cptr = NULL)
+	{
+		if (m_count < HAM_MAX_PARAMS)
+		{
+			m_params[m_count++] = Data(type, ptr, cptr);
+		}
+	};
+
+	inline size_t length()
+	{
+		return m_count;
+	};
+
+	inline Data *at(size_t i)
+	{
+		return &m_params[i];
+	};
+};
+
 extern CStack< Data * > ReturnStack;
 extern CStack< Data * > OrigReturnStack;
-extern CStack< ke::Vector< Data * > * > ParamStack;
+extern CStack< ParamFrame * > ParamStack;
 extern CStack< int * > ReturnStatus;
 #endif
@@ -17,6 +17,8 @@
 #define FORWARD_H
 
 #include <amtl/am-refcounting.h>
+#include <amtl/am-vector.h>
+#include <amtl/am-string.h>
 
 enum fwdstate
 {
@@ -32,11 +34,19 @@ class Forward :public ke::Refcounted<Forward>
 public:
 	int      id;    // id of the forward
 	fwdstate state;
-	Forward(int id_) : id(id_), state(FSTATE_OK)
+
+	// Optional filters, checked before the plugin is entered
+	bool                 filtered;        // any of the below is set
+	bool                 byEntity;        // only entities set in the bitmap
+	ke::Vector<uint32_t> entities;        // bitmap of entity indexes
+	ke::AString          classname;       // only entities of this class, empty for all
+	string_t             classnameMatch;  // last pev->classname seen to match
+
+	Forward(int id_) : id(id_), state(FSTATE_OK), filtered(false), byEntity(false), classnameMatch(0)
 	{
 		/* do nothing */
 	};
-	Forward() : id(-1), state(FSTATE_INVALID)
+	Forward() : id(-1), state(FSTATE_INVALID), filtered(false), byEntity(false), classnameMatch(0)
 	{
 		/* do nothing */
 	}
@@ -50,6 +60,16 @@ public:
 		id=i;
 	};
 
+	inline bool Accepts(int index)
+	{
+		return !filtered || AcceptsFiltered(index);
+	};
+
+	bool AcceptsFiltered(int index);
+	void SetEntity(int index, bool enable);
+	void SetClassname(const char *name);
+	void ClearFilters();
+
 };
 
 #endif
@@ -33,58 +33,105 @@
 
 extern bool gDoForwards;
 
+// Only calls a plugin can see get their return values and parameters
+// pushed; the frame itself always lives on the callback's stack.
+static inline bool HookHasForwards(Hook *hook)
+{
+	if (!gDoForwards)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < hook->pre.length(); ++i)
+	{
+		if (hook->pre.at(i)->state == FSTATE_OK)
+		{
+			return true;
+		}
+	}
+
+	for (size_t i = 0; i < hook->post.length(); ++i)
+	{
+		if (hook->post.at(i)->state == FSTATE_OK)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 // Return value pushes
-#define PUSH_VOID() ReturnStack.push(new Data(RET_VOID, NULL));				OrigReturnStack.push(new Data(RET_VOID, NULL));
-#define PUSH_BOOL() ReturnStack.push(new Data(RET_BOOL, (void *)&ret));		OrigReturnStack.push(new Data(RET_BOOL, (void *)&origret));
-#define PUSH_INT() ReturnStack.push(new Data(RET_INTEGER, (void *)&ret));	OrigReturnStack.push(new Data(RET_INTEGER, (void *)&origret));
-#define PUSH_FLOAT() ReturnStack.push(new Data(RET_FLOAT, (void *)&ret));	OrigReturnStack.push(new Data(RET_FLOAT, (void *)&origret));
-#define PUSH_VECTOR() ReturnStack.push(new Data(RET_VECTOR, (void *)&ret)); OrigReturnStack.push(new Data(RET_VECTOR, (void *)&origret));
-#define PUSH_CBASE() ReturnStack.push(new Data(RET_CBASE, (void *)&ret));	OrigReturnStack.push(new Data(RET_CBASE, (void *)&origret));
-#define PUSH_STRING() ReturnStack.push(new Data(RET_STRING, (void *)&ret)); OrigReturnStack.push(new Data(RET_STRING, (void *)&origret));
+#define PUSH_RETURN(__TYPE, __RET, __ORIGRET)									\
+	bool __active=HookHasForwards(hook);										\
+	Data __ret(__TYPE, __RET);													\
+	Data __origret(__TYPE, __ORIGRET);											\
+	if (__active)																\
+	{																			\
+		ReturnStack.push(&__ret);												\
+		OrigReturnStack.push(&__origret);										\
+	}
+
+#define PUSH_VOID()		PUSH_RETURN(RET_VOID, NULL, NULL)
+#define PUSH_BOOL()		PUSH_RETURN(RET_BOOL, (void *)&ret, (void *)&origret)
+#define PUSH_INT()		PUSH_RETURN(RET_INTEGER, (void *)&ret, (void *)&origret)
+#define PUSH_FLOAT()	PUSH_RETURN(RET_FLOAT, (void *)&ret, (void *)&origret)
+#define PUSH_VECTOR()	PUSH_RETURN(RET_VECTOR, (void *)&ret, (void *)&origret)
+#define PUSH_CBASE()	PUSH_RETURN(RET_CBASE, (void *)&ret, (void *)&origret)
+#define PUSH_STRING()	PUSH_RETURN(RET_STRING, (void *)&ret, (void *)&origret)
 
 // Pop off return values
-#define POP() delete ReturnStack.front(); ReturnStack.pop(); delete OrigReturnStack.front(); OrigReturnStack.pop();
+#define POP()																	\
+	if (__active)																\
+	{																			\
+		ReturnStack.pop();														\
+		OrigReturnStack.pop();													\
+	}
 
 // Parameter value pushes
 #define MAKE_VECTOR()															\
-	int iThis=TypeConversion.cbase_to_id(pthis);											\
-	ke::Vector<Data *> *__vec=new ke::Vector<Data *>;							\
-	ParamStack.push(__vec);														\
+	int iThis=__active ? TypeConversion.cbase_to_id(pthis) : 0;					\
+	ParamFrame __frame;															\
+	ParamFrame *__vec=&__frame;													\
+	if (__active)																\
+	{																			\
+		ParamStack.push(__vec);													\
+	}																			\
 	P_CBASE(pthis, iThis)
 
-#define P_BOOL(___PARAM)			__vec->append(new Data(RET_BOOL, (void *) & (___PARAM)));
-#define P_INT(___PARAM)				__vec->append(new Data(RET_INTEGER, (void *) & (___PARAM)));
-#define P_SHORT(___PARAM)			__vec->append(new Data(RET_SHORT, (void *) & (___PARAM)));
-#define P_FLOAT(___PARAM)			__vec->append(new Data(RET_FLOAT, (void *) & (___PARAM)));			
-#define P_VECTOR(___PARAM)			__vec->append(new Data(RET_VECTOR, (void *) & (___PARAM)));
-#define P_STR(___PARAM)				__vec->append(new Data(RET_STRING, (void *) & (___PARAM)));
-#define P_CBASE(__PARAM, __INDEX)	__vec->append(new Data(RET_CBASE, (void *) & (__PARAM), reinterpret_cast<int *>(& (__INDEX))));
-#define P_ENTVAR(__PARAM, __INDEX)	__vec->append(new Data(RET_ENTVAR, (void *) & (__PARAM), reinterpret_cast<int *>(& (__INDEX))));
-#define P_EDICT(__PARAM, __INDEX)	__vec->append(new Data(RET_EDICT, (void *) & (__PARAM), reinterpret_cast<int *>(& (__INDEX))));
-#define P_TRACE(__PARAM)			__vec->append(new Data(RET_TRACE, (void *) (__PARAM)));
-#define P_PTRVECTOR(__PARAM)		__vec->append(new Data(RET_VECTOR, (void *) (__PARAM)));
-#define P_PTRFLOAT(__PARAM)			__vec->append(new Data(RET_FLOAT, (void *) (__PARAM)));
-#define P_ITEMINFO(__PARAM)			__vec->append(new Data(RET_ITEMINFO, (void *) & (__PARAM)));
+#define P_BOOL(___PARAM)			if (__active) __vec->append(RET_BOOL, (void *) & (___PARAM));
+#define P_INT(___PARAM)				if (__active) __vec->append(RET_INTEGER, (void *) & (___PARAM));
+#define P_SHORT(___PARAM)			if (__active) __vec->append(RET_SHORT, (void *) & (___PARAM));
+#define P_FLOAT(___PARAM)			if (__active) __vec->append(RET_FLOAT, (void *) & (___PARAM));
+#define P_VECTOR(___PARAM)			if (__active) __vec->append(RET_VECTOR, (void *) & (___PARAM));
+#define P_STR(___PARAM)				if (__active) __vec->append(RET_STRING, (void *) & (___PARAM));
+#define P_CBASE(__PARAM, __INDEX)	if (__active) __vec->append(RET_CBASE, (void *) & (__PARAM), reinterpret_cast<int *>(& (__INDEX)));
+#define P_ENTVAR(__PARAM, __INDEX)	if (__active) __vec->append(RET_ENTVAR, (void *) & (__PARAM), reinterpret_cast<int *>(& (__INDEX)));
+#define P_EDICT(__PARAM, __INDEX)	if (__active) __vec->append(RET_EDICT, (void *) & (__PARAM), reinterpret_cast<int *>(& (__INDEX)));
+#define P_TRACE(__PARAM)			if (__active) __vec->append(RET_TRACE, (void *) (__PARAM));
+#define P_PTRVECTOR(__PARAM)		if (__active) __vec->append(RET_VECTOR, (void *) (__PARAM));
+#define P_PTRFLOAT(__PARAM)			if (__active) __vec->append(RET_FLOAT, (void *) (__PARAM));
+#define P_ITEMINFO(__PARAM)			if (__active) __vec->append(RET_ITEMINFO, (void *) & (__PARAM));
 
 #define KILL_VECTOR()															\
-	for (size_t i = 0; i < __vec->length(); ++i)									\
+	if (__active)																\
 	{																			\
-		delete __vec->at(i);														\
-	}																			\
-	delete __vec;																\
-	ParamStack.pop();
+		ParamStack.pop();														\
+	}
 
 #define PRE_START()																\
-	bool DoForwards=gDoForwards;												\
 	gDoForwards=true;															\
 	int result=HAM_UNSET;														\
-	ReturnStatus.push(&result);													\
+	if (__active)																\
+	{																			\
+		ReturnStatus.push(&result);												\
+	}																			\
 	int thisresult=HAM_UNSET;													\
-	if (DoForwards)																\
+	if (__active)																\
 	{																			\
 		for (size_t i = 0; i < hook->pre.length(); ++i)							\
 		{																		\
-			if (hook->pre.at(i)->state == FSTATE_OK)							\
+			if (hook->pre.at(i)->state == FSTATE_OK && hook->pre.at(i)->Accepts(iThis))	\
 			{																	\
 				thisresult = MF_ExecuteForward(hook->pre.at(i)->id, iThis
 
@@ -102,11 +149,11 @@ extern bool gDoForwards;
 
 #define POST_START()														\
 	}																		\
-	if (DoForwards)															\
+	if (__active)															\
 	{																		\
 		for (size_t i = 0; i < hook->post.length(); ++i)					\
 		{																	\
-			if (hook->post.at(i)->state == FSTATE_OK)						\
+			if (hook->post.at(i)->state == FSTATE_OK && hook->post.at(i)->Accepts(iThis))	\
 			{																\
 					thisresult = MF_ExecuteForward(hook->post.at(i)->id, iThis
 
@@ -119,7 +166,10 @@ extern bool gDoForwards;
 			}															\
 		}																\
 	}																	\
-	ReturnStatus.pop();
+	if (__active)														\
+	{																	\
+		ReturnStatus.pop();												\
+	}
 
 
 #define CHECK_RETURN()													\
@@ -976,9 +1026,10 @@ const char *Hook_Str_Void(Hook *hook, void *pthis)
 	ke::AString ret;
 	ke::AString origret;
 
+	PUSH_STRING()
+
 	MAKE_VECTOR()
 
-	PUSH_STRING()
 	PRE_START()
 	PRE_END()
 
@@ -3305,10 +3356,10 @@ const char *Hook_Str_Str(Hook *hook, void *pthis, const char* str)
 	
 	a = str;
 
-	MAKE_VECTOR()
-
 	PUSH_STRING()
 
+	MAKE_VECTOR()
+
 	P_STR(a)
 
 	PRE_START()
@@ -847,6 +847,160 @@ static cell AMX_NATIVE_CALL EnableHamForward(AMX *amx, cell *params)
 	fwd->state=FSTATE_OK;
 	return 0;
 }
+bool Forward::AcceptsFiltered(int index)
+{
+	if (byEntity)
+	{
+		size_t word = static_cast<size_t>(index) >> 5;
+
+		if (index < 0 || word >= entities.length() || !(entities[word] & (1u << (index & 31))))
+		{
+			return false;
+		}
+	}
+
+	if (classname.length())
+	{
+		edict_t *pEdict = TypeConversion.id_to_edict(index);
+
+		if (!pEdict)
+		{
+			return false;
+		}
+
+		string_t entClassname = pEdict->v.classname;
+
+		// classnames allocated once compare equal by offset, only fall back to strcmp on a miss
+		if (entClassname != classnameMatch)
+		{
+			if (!entClassname || strcmp(STRING(entClassname), classname.chars()) != 0)
+			{
+				return false;
+			}
+
+			classnameMatch = entClassname;
+		}
+	}
+
+	return true;
+}
+
+void Forward::SetEntity(int index, bool enable)
+{
+	size_t word = static_cast<size_t>(index) >> 5;
+
+	if (!enable)
+	{
+		if (word < entities.length())
+		{
+			entities[word] &= ~(1u << (index & 31));
+		}
+
+		// the last entity removed lifts the entity filter
+		for (size_t i = 0; i < entities.length(); ++i)
+		{
+			if (entities[i])
+			{
+				return;
+			}
+		}
+
+		entities.clear();
+		byEntity = false;
+		filtered = classname.length() != 0;
+		return;
+	}
+
+	if (word >= entities.length())
+	{
+		size_t length = entities.length();
+
+		if (!entities.resize(word + 1))
+		{
+			return;
+		}
+
+		for (; length < entities.length(); ++length)
+		{
+			entities[length] = 0;
+		}
+	}
+
+	entities[word] |= (1u << (index & 31));
+
+	byEntity = true;
+	filtered = true;
+}
+
+void Forward::SetClassname(const char *name)
+{
+	classname = name;
+	classnameMatch = 0;
+	filtered = byEntity || classname.length() != 0;
+}
+
+void Forward::ClearFilters()
+{
+	entities.clear();
+	classname = "";
+	classnameMatch = 0;
+	byEntity = false;
+	filtered = false;
+}
+
+// SetHamForwardEntity(HamHook:fwd, entity, bool:enable = true)
+static cell AMX_NATIVE_CALL SetHamForwardEntity(AMX *amx, cell *params)
+{
+	Forward *fwd=reinterpret_cast<Forward *>(params[1]);
+
+	if (fwd == 0)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid HamHook handle.");
+		return 0;
+	}
+
+	int entity = params[2];
+
+	if (entity < 0 || entity > gpGlobals->maxEntities)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Entity out of range (%d)", entity);
+		return 0;
+	}
+
+	fwd->SetEntity(entity, params[3] != 0);
+	return 1;
+}
+
+// SetHamForwardClassname(HamHook:fwd, const classname[])
+static cell AMX_NATIVE_CALL SetHamForwardClassname(AMX *amx, cell *params)
+{
+	Forward *fwd=reinterpret_cast<Forward *>(params[1]);
+
+	if (fwd == 0)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid HamHook handle.");
+		return 0;
+	}
+
+	fwd->SetClassname(MF_GetAmxString(amx, params[2], 0, NULL));
+	return 1;
+}
+
+// ClearHamForwardFilters(HamHook:fwd)
+static cell AMX_NATIVE_CALL ClearHamForwardFilters(AMX *amx, cell *params)
+{
+	Forward *fwd=reinterpret_cast<Forward *>(params[1]);
+
+	if (fwd == 0)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid HamHook handle.");
+		return 0;
+	}
+
+	fwd->ClearFilters();
+	return 1;
+}
+
 AMX_NATIVE_INFO RegisterNatives[] =
 {
 	{ "RegisterHam",			RegisterHam },
@@ -856,6 +1010,9 @@ AMX_NATIVE_INFO RegisterNatives[] =
 	{ "IsHamValid",				IsHamValid },
 	{ "DisableHamForward",		DisableHamForward },
 	{ "EnableHamForward",		EnableHamForward },
+	{ "SetHamForwardEntity",	SetHamForwardEntity },
+	{ "SetHamForwardClassname",	SetHamForwardClassname },
+	{ "ClearHamForwardFilters",	ClearHamForwardFilters },
 
 	{ NULL,						NULL }
 };
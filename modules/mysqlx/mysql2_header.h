@@ -38,6 +38,7 @@ enum HandleType
 	Handle_Query,
 	Handle_OldDb,
 	Handle_OldResult,
+	Handle_Transaction,
 };
 
 struct SQL_Connection
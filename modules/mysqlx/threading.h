@@ -17,6 +17,8 @@
 #include "IThreader.h"
 #include "ISQLDriver.h"
 #include <amtl/am-string.h>
+#include <amtl/am-vector.h>
+#include <sm_stringhashmap.h>
 #include <sh_stack.h>
 
 struct QueuedResultInfo
@@ -57,17 +59,58 @@ public:
 	virtual const char *GetRaw(unsigned int columnId, size_t *length);
 public:
 	void CopyFrom(IResultSet *rs);
+private:
+	// Every string of the result lives in one arena, cells only point into it.
+	// The arena is kept between queries, the thread objects are pooled.
+	struct ResultCell
+	{
+		size_t offset;
+		size_t length;
+	};
 private:
 	void _InternalClear();
+	void _StoreCell(ResultCell *pCell, const char *str);
 private:
 	unsigned int m_RowCount;
 	unsigned int m_FieldCount;
 	size_t m_AllocSize;
-	ke::AString **m_Table;
+	ResultCell *m_Cells;			// row 0 holds the column names
+	char *m_Arena;
+	size_t m_ArenaSize;
+	size_t m_ArenaUsed;
+	StringHashMap<unsigned int> m_FieldIndex;
+	bool m_IndexBuilt;
 	unsigned int m_CurRow;
 	bool m_IsFree;
 };
 
+struct TransactionQuery
+{
+	TransactionQuery() : handle(0)
+	{
+		amxinfo.pQuery = NULL;
+	};
+	~TransactionQuery()
+	{
+		delete [] amxinfo.opt_ptr;
+	};
+	AmxQueryInfo amxinfo;		// opt_ptr holds the query string
+	AtomicResult result;
+	unsigned int handle;		// query handle while the transaction handler runs
+};
+
+class SQL_Transaction
+{
+public:
+	SQL_Transaction() : executing(false), freed(false), inHandler(false) { };
+	~SQL_Transaction();
+public:
+	ke::Vector<TransactionQuery *> queries;
+	bool executing;				// queued, or its handler is running
+	bool freed;					// handle freed while executing, deleted once done
+	bool inHandler;
+};
+
 class MysqlThread : public IThread
 {
 public:
@@ -79,11 +122,15 @@ public:
 	void SetQuery(const char *query);
 	void SetCellData(cell data[], ucell len);
 	void SetForward(int forward);
+	void SetTransaction(SQL_Transaction *txn, unsigned int handle);
 	void Invalidate();
 	void Execute();
 public:
 	void RunThread(IThreadHandle *pHandle);
 	void OnTerminate(IThreadHandle *pHandle, bool cancel);
+private:
+	void RunTransaction(IDatabase *pDatabase);
+	void ExecuteTransaction(int state, cell data_addr, cell c_diff);
 private:
 	ke::AString m_query;
 	ke::AString m_host;
@@ -99,6 +146,9 @@ private:
 	int m_fwd;
 	QueuedResultInfo m_qrInfo;
 	AtomicResult m_atomicResult;
+	SQL_Transaction *m_txn;
+	unsigned int m_txnHandle;
+	int m_failIndex;
 };
 
 #endif //_INCLUDE_MYSQL_THREADING_H
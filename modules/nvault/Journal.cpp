@@ -15,12 +15,23 @@
 #include <stdarg.h>
 #if defined(__linux__) || defined(__APPLE__)
 #include <unistd.h>
+#else
+#include <io.h>
 #endif
 #include "Journal.h"
 
 Journal::Journal(const char *file)
 {
 	m_File = file;
+	m_fp = NULL;
+	m_Buffer = NULL;
+	m_Pending = false;
+	m_Ops = 0;
+}
+
+Journal::~Journal()
+{
+	End();
 }
 
 bool Journal::Erase()
@@ -152,14 +163,30 @@ fail:
 
 success:
 	fclose(m_fp);
+	m_fp = NULL;
 
 	return ops;
 }
 
 bool Journal::Begin()
 {
-	m_fp = fopen(m_File.chars(), "wb");
+	return OpenFile("wb");
+}
+
+bool Journal::OpenFile(const char *mode)
+{
+	m_fp = fopen(m_File.chars(), mode);
 	m_Bw.SetFilePtr(m_fp);
+	m_Pending = false;
+	m_Ops = 0;
+
+	if (m_fp)
+	{
+		if (!m_Buffer)
+			m_Buffer = new char[JOURNAL_BUFFER_SIZE];
+		setvbuf(m_fp, m_Buffer, _IOFBF, JOURNAL_BUFFER_SIZE);
+	}
+
 	return (m_fp != NULL);
 }
 
@@ -168,7 +195,51 @@ bool Journal::End()
 	if (m_fp)
 		fclose(m_fp);
 
+	m_fp = NULL;
 	m_Bw.SetFilePtr(NULL);
+	m_Pending = false;
+
+	delete [] m_Buffer;
+	m_Buffer = NULL;
+
+	return true;
+}
+
+bool Journal::Commit(bool sync)
+{
+	if (!m_fp || !m_Pending)
+		return true;
+
+	m_Pending = false;
+
+	if (fflush(m_fp) != 0)
+		return false;
+
+	if (!sync)
+		return true;
+
+#if defined(__linux__) || defined(__APPLE__)
+	return (fsync(fileno(m_fp)) == 0);
+#else
+	return (_commit(_fileno(m_fp)) == 0);
+#endif
+}
+
+bool Journal::Rotate(const char *oldFile)
+{
+	// everything written so far moves to oldFile, a new journal starts empty
+	End();
+	unlink(oldFile);
+
+	if (rename(m_File.chars(), oldFile) != 0)
+	{
+		// keep appending to what we have
+		OpenFile("ab");
+		return false;
+	}
+
+	Begin();
+
 	return true;
 }
 
@@ -235,6 +306,11 @@ bool Journal::WriteInt32(int num)
 
 bool Journal::WriteOp(JOp op)
 {
+	if (!m_fp)
+		return false;
+
+	m_Pending = true;
+	m_Ops++;
 	return m_Bw.WriteUInt8(static_cast<uint8_t>(op));
 }
 
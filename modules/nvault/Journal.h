@@ -19,6 +19,8 @@
 #include <sm_stringhashmap.h>
 #include <amtl/am-string.h>
 
+#define JOURNAL_BUFFER_SIZE		65536
+
 enum JOp
 {
 	Journal_Nop=0,		//no operation
@@ -47,17 +49,22 @@ class Journal
 {
 public:
 	Journal(const char *file);
+	~Journal();
 public:
 	bool Begin();
 	bool End();
 	int Replay(VaultMap *pMap);
 	bool Erase();
+	bool Commit(bool sync);
+	bool Rotate(const char *oldFile);
+	size_t Ops() { return m_Ops; }
 public:
 	bool Write_Clear();
 	bool Write_Prune(time_t start, time_t end);
 	bool Write_Insert(const char *key, const char *val, time_t stamp);
 	bool Write_Remove(const char *key);
 private:
+	bool OpenFile(const char *mode);
 	bool WriteOp(JOp op);
 	bool WriteInt32(int num);
 	bool WriteString(const char *str, Encode enc);
@@ -65,6 +72,9 @@ private:
 	ke::AString m_File;
 	FILE *m_fp;
 	BinaryWriter m_Bw;
+	char *m_Buffer;			// ops stay here until the next Commit, unless it fills up
+	bool m_Pending;
+	size_t m_Ops;			// written since Begin
 };
 
 #endif //_INCLUDE_JOURNAL_H
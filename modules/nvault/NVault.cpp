@@ -16,6 +16,11 @@
 #include "NVault.h"
 #include "Binary.h"
 #include <amtl/am-string.h>
+#if defined(__linux__) || defined(__APPLE__)
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
 
 /** 
  * :TODO: This beast calls strcpy()/new() way too much by creating new strings on the stack.
@@ -27,6 +32,8 @@ NVault::NVault(const char *file)
 {
 	m_File = file;
 	m_Journal = NULL;
+	m_CompactState = Compact_Idle;
+	m_CanCompact = true;
 	m_Open = false;
 
 	FILE *fp = fopen(m_File.chars(), "rb");
@@ -234,9 +241,20 @@ bool NVault::Open()
 	}
 
 	m_Journal = new Journal(journal_name);
+	m_OldJournal = journal_name;
+	m_OldJournal.append(".old");
 	delete [] journal_name;
 
-	m_Journal->Replay(&m_Hash);
+	// a compaction that didn't finish leaves its journal behind, it goes first
+	Journal oldJournal(m_OldJournal.chars());
+	int replayed = oldJournal.Replay(&m_Hash);
+
+	if (m_Journal->Replay(&m_Hash) > 0 || replayed > 0)
+	{
+		_SaveToFile();
+	}
+
+	oldJournal.Erase();
 	m_Journal->Erase();
 	if (!m_Journal->Begin())
 	{
@@ -244,6 +262,7 @@ bool NVault::Open()
 		m_Journal = NULL;
 	}
 	
+	m_CanCompact = true;
 	m_Open = true;
 
 	return true;
@@ -254,19 +273,145 @@ bool NVault::Close()
 	if (!m_Open)
 		return false;
 
+	_FinishCompaction(true);
 	_SaveToFile();
 
 	if (m_Journal) 
 	{
 		m_Journal->End();
 		m_Journal->Erase();
+		delete m_Journal;
+		m_Journal = NULL;
 	}
 
+	unlink(m_OldJournal.chars());
+
 	m_Open = false;
 
 	return true;
 }
 
+void NVault::Commit(int sync, size_t compactOps)
+{
+	if (!m_Journal)
+		return;
+
+	if (sync > 0)
+		m_Journal->Commit(sync > 1);
+
+	_FinishCompaction(false);
+
+	if (compactOps && m_CanCompact && m_CompactState == Compact_Idle && m_Journal->Ops() >= compactOps)
+	{
+		_StartCompaction();
+	}
+}
+
+void NVault::_StartCompaction()
+{
+	// from here on the journal only holds what the snapshot doesn't
+	if (!m_Journal->Rotate(m_OldJournal.chars()))
+	{
+		m_CanCompact = false;
+		return;
+	}
+
+	VaultSnapshot *snapshot = new VaultSnapshot;
+	snapshot->file = m_File;
+
+	if (!snapshot->entries.resize(m_Hash.elements()))
+	{
+		delete snapshot;
+		m_CanCompact = false;
+		return;
+	}
+
+	size_t i = 0;
+	for (StringHashMap<ArrayInfo>::iterator iter = m_Hash.iter(); !iter.empty(); iter.next(), i++)
+	{
+		VaultSnapshot::Entry &entry = snapshot->entries[i];
+		entry.key = (*iter).key;
+		entry.value = (*iter).value.value;
+		entry.stamp = (*iter).value.stamp;
+	}
+
+	m_CompactState = Compact_Running;
+	m_Compactor = std::thread(&NVault::_Compact, this, snapshot);
+}
+
+void NVault::_FinishCompaction(bool wait)
+{
+	int state = m_CompactState;
+	if (state == Compact_Idle || (state == Compact_Running && !wait))
+		return;
+
+	m_Compactor.join();
+
+	if (m_CompactState == Compact_Done)
+	{
+		unlink(m_OldJournal.chars());
+	}
+	else
+	{
+		// the old journal is still needed, don't let another rotation replace it
+		m_CanCompact = false;
+	}
+
+	m_CompactState = Compact_Idle;
+}
+
+// runs on its own thread, only touches the snapshot
+void NVault::_Compact(VaultSnapshot *snapshot)
+{
+	ke::AString temp(snapshot->file);
+	temp.append(".tmp");
+
+	bool written = false;
+	FILE *fp = fopen(temp.chars(), "wb");
+
+	if (fp)
+	{
+		BinaryWriter bw(fp);
+		size_t i;
+
+		written = bw.WriteUInt32(VAULT_MAGIC) &&
+				  bw.WriteUInt16(VAULT_VERSION) &&
+				  bw.WriteUInt32(snapshot->entries.length());
+
+		for (i = 0; written && i < snapshot->entries.length(); i++)
+		{
+			const VaultSnapshot::Entry &entry = snapshot->entries[i];
+
+			written = bw.WriteInt32(static_cast<int32_t>(entry.stamp)) &&
+					  bw.WriteUInt8(entry.key.length()) &&
+					  bw.WriteUInt16(entry.value.length()) &&
+					  bw.WriteChars(entry.key.chars(), entry.key.length()) &&
+					  bw.WriteChars(entry.value.chars(), entry.value.length());
+		}
+
+		if (fclose(fp) != 0)
+			written = false;
+	}
+
+	if (written)
+	{
+#if defined(WIN32)
+		written = (MoveFileExA(temp.chars(), snapshot->file.chars(), MOVEFILE_REPLACE_EXISTING) != 0);
+#else
+		written = (rename(temp.chars(), snapshot->file.chars()) == 0);
+#endif
+	}
+
+	if (!written)
+	{
+		unlink(temp.chars());
+	}
+
+	delete snapshot;
+
+	m_CompactState = written ? Compact_Done : Compact_Failed;
+}
+
 void NVault::SetValue(const char *key, const char *val)
 {
 	if (m_Journal)
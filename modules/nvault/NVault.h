@@ -15,7 +15,10 @@
 #define _INCLUDE_NVAULT_H
 
 #include <amtl/am-linkedlist.h>
+#include <amtl/am-vector.h>
 #include <sm_stringhashmap.h>
+#include <atomic>
+#include <thread>
 #include "IVault.h"
 #include "Journal.h"
 
@@ -34,6 +37,27 @@
 //  val ([])
 //  ]
 
+enum CompactState
+{
+	Compact_Idle=0,
+	Compact_Running,
+	Compact_Done,
+	Compact_Failed,
+};
+
+struct VaultSnapshot
+{
+	struct Entry
+	{
+		ke::AString key;
+		ke::AString value;
+		time_t stamp;
+	};
+
+	ke::AString file;
+	ke::Vector<Entry> entries;
+};
+
 enum VaultError
 {
 	Vault_Ok=0,
@@ -61,13 +85,21 @@ public:
 	bool Close();
 	size_t Items();
 	const char *GetFilename() { return m_File.chars(); }
+	void Commit(int sync, size_t compactOps);
 private:
 	VaultError _ReadFromFile();
 	bool _SaveToFile();
+	void _StartCompaction();
+	void _FinishCompaction(bool wait);
+	void _Compact(VaultSnapshot *snapshot);
 private:
 	ke::AString m_File;
 	StringHashMap<ArrayInfo> m_Hash;
 	Journal *m_Journal;
+	ke::AString m_OldJournal;				// ops a running compaction already covers
+	std::thread m_Compactor;
+	std::atomic<int> m_CompactState;
+	bool m_CanCompact;
 	bool m_Open;
 	
 	bool m_Valid;
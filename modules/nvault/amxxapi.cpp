@@ -34,6 +34,13 @@ ke::Deque<int> g_OldVaults;
 
 VaultMngr g_VaultMngr;
 
+// 0 leaves journal writes to the C runtime, 1 flushes them once per frame, 2 also fsyncs them
+cvar_t init_nvault_sync = {"nvault_sync", "1"};
+// journal ops after which a vault is rewritten in the background, 0 never
+cvar_t init_nvault_compact = {"nvault_compact", "10000"};
+cvar_t *nvault_sync;
+cvar_t *nvault_compact;
+
 #ifndef _WIN32
 extern "C" void __cxa_pure_virtual(void)
 {
@@ -254,6 +261,32 @@ void OnAmxxAttach()
 	MF_RegisterFunction((void *)GetVaultMngr, "GetVaultMngr");
 }
 
+void OnMetaAttach()
+{
+	CVAR_REGISTER(&init_nvault_sync);
+	CVAR_REGISTER(&init_nvault_compact);
+	nvault_sync = CVAR_GET_POINTER(init_nvault_sync.name);
+	nvault_compact = CVAR_GET_POINTER(init_nvault_compact.name);
+}
+
+void StartFrame()
+{
+	// group commit: everything written during the last frame goes out at once
+	if (g_Vaults.length())
+	{
+		int sync = static_cast<int>(nvault_sync->value);
+		size_t compact = nvault_compact->value > 0.0f ? static_cast<size_t>(nvault_compact->value) : 0;
+
+		for (size_t i=0; i<g_Vaults.length(); i++)
+		{
+			if (g_Vaults[i])
+				g_Vaults[i]->Commit(sync, compact);
+		}
+	}
+
+	RETURN_META(MRES_IGNORED);
+}
+
 void OnPluginsUnloaded()
 {
 	for (size_t i=0; i<g_Vaults.length(); i++)
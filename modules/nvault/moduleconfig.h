@@ -34,7 +34,7 @@
 #endif // __DATE__
 
 // metamod plugin?
-// #define USE_METAMOD
+#define USE_METAMOD
 
 // use memory manager/tester?
 // note that if you use this, you cannot construct/allocate 
@@ -89,7 +89,7 @@
 // Meta query
 //#define FN_META_QUERY OnMetaQuery
 // Meta attach
-//#define FN_META_ATTACH OnMetaAttach
+#define FN_META_ATTACH OnMetaAttach
 // Meta detach
 //#define FN_META_DETACH OnMetaDetach
 
@@ -120,7 +120,7 @@
 // #define FN_ServerDeactivate			ServerDeactivate			/* pfnServerDeactivate()		(wd) Server is leaving the map (shutdown or changelevel); SDK2 */
 // #define FN_PlayerPreThink			PlayerPreThink				/* pfnPlayerPreThink() */
 // #define FN_PlayerPostThink			PlayerPostThink				/* pfnPlayerPostThink() */
-// #define FN_StartFrame				StartFrame					/* pfnStartFrame() */
+#define FN_StartFrame				StartFrame					/* pfnStartFrame() */
 // #define FN_ParmsNewLevel				ParmsNewLevel				/* pfnParmsNewLevel() */
 // #define FN_ParmsChangeLevel			ParmsChangeLevel			/* pfnParmsChangeLevel() */
 // #define FN_GetGameDescription		GetGameDescription			/* pfnGetGameDescription()		Returns string describing current .dll.  E.g. "TeamFotrress 2" "Half-Life" */
@@ -18,11 +18,88 @@
 #include <ctype.h>
 #include "utils.h"
 
+// Shared by every JIT compiled pattern, the module only runs on the main thread.
+static pcre_jit_stack *JitStack = NULL;
+
+RegExCode::RegExCode()
+{
+	re = NULL;
+	extra = NULL;
+	mRefs = 1;
+}
+
+RegExCode::~RegExCode()
+{
+	if (extra)
+		pcre_free_study(extra);
+	if (re)
+		pcre_free(re);
+}
+
+RegExCode *RegExCode::Compile(const char *pattern, int iFlags, const char **error, int *errorOffset)
+{
+	pcre *re = pcre_compile(pattern, iFlags, error, errorOffset, NULL);
+
+	if (re == NULL)
+	{
+		return NULL;
+	}
+
+	RegExCode *code = new RegExCode();
+	code->re = re;
+
+	/**
+	 * Studying never fails the compilation, without JIT support
+	 * or on error we are just left with the interpreter.
+	 */
+	const char *studyError = NULL;
+	code->extra = pcre_study(re, PCRE_STUDY_JIT_COMPILE, &studyError);
+
+	if (code->extra)
+	{
+		if (JitStack == NULL)
+		{
+			JitStack = pcre_jit_stack_alloc(32 * 1024, 512 * 1024);
+		}
+
+		if (JitStack)
+		{
+			pcre_assign_jit_stack(code->extra, NULL, JitStack);
+		}
+	}
+
+	return code;
+}
+
+void RegExCode::FreeJitStack()
+{
+	if (JitStack)
+	{
+		pcre_jit_stack_free(JitStack);
+		JitStack = NULL;
+	}
+}
+
+void RegExCode::AddRef()
+{
+	mRefs++;
+}
+
+void RegExCode::Release()
+{
+	if (--mRefs == 0)
+	{
+		delete this;
+	}
+}
+
 RegEx::RegEx()
 {
 	mErrorOffset = 0;
 	mError = NULL;
+	mCode = NULL;
 	re = NULL;
+	extra = NULL;
 	mFree = true;
 	subject = NULL;
 	mSubStrings.clear();
@@ -35,9 +112,11 @@ void RegEx::Clear()
 {
 	mErrorOffset = 0;
 	mError = NULL;
-	if (re)
-		pcre_free(re);
+	if (mCode)
+		mCode->Release();
+	mCode = NULL;
 	re = NULL;
+	extra = NULL;
 	mFree = true;
 	if (subject)
 		delete[] subject;
@@ -64,14 +143,10 @@ bool RegEx::isFree(bool set, bool val)
 	}
 }
 
-int RegEx::Compile(const char *pattern, const char* flags)
+int RegEx::ParseFlags(const char *flags)
 {
-	if (!mFree)
-		Clear();
-
-		
 	int iFlags = 0;
-	
+
 	if (flags != NULL)
 	{
 		for ( ; *flags != 0; flags++)
@@ -105,15 +180,31 @@ int RegEx::Compile(const char *pattern, const char* flags)
 			}
 		}
 	}
-		
-	re = pcre_compile(pattern, iFlags, &mError, &mErrorOffset, NULL);
 
-	if (re == NULL)
+	return iFlags;
+}
+
+void RegEx::UseCode(RegExCode *code)
+{
+	mCode = code;
+	re = code->re;
+	extra = code->extra;
+	mFree = false;
+}
+
+int RegEx::Compile(const char *pattern, const char* flags)
+{
+	if (!mFree)
+		Clear();
+
+	RegExCode *code = RegExCode::Compile(pattern, ParseFlags(flags), &mError, &mErrorOffset);
+
+	if (code == NULL)
 	{
 		return 0;
 	}
 
-	mFree = false;
+	UseCode(code);
 
 	return 1;
 }
@@ -123,14 +214,24 @@ int RegEx::Compile(const char *pattern, int iFlags)
 	if (!mFree)
 		Clear();
 
-	re = pcre_compile(pattern, iFlags, &mError, &mErrorOffset, NULL);
+	RegExCode *code = RegExCode::Compile(pattern, iFlags, &mError, &mErrorOffset);
 
-	if (re == NULL)
+	if (code == NULL)
 	{
 		return 0;
 	}
 
-	mFree = false;
+	Attach(code);
+
+	return 1;
+}
+
+void RegEx::Attach(RegExCode *code)
+{
+	if (!mFree)
+		Clear();
+
+	UseCode(code);
 
 	/**
 	 * Retrieve the number of captured groups
@@ -144,8 +245,6 @@ int RegEx::Compile(const char *pattern, int iFlags)
 	 * which contain an index and a name per group.
 	 */
 	MakeSubpatternsTable(mNumSubpatterns);
-
-	return 1;
 }
 
 int RegEx::Match(const char *str)
@@ -161,7 +260,7 @@ int RegEx::Match(const char *str)
 	subject = new char[strlen(str) + 1];
 	strcpy(subject, str);
 
-	rc = pcre_exec(re, NULL, subject, (int)strlen(subject), 0, 0, ovector, REGEX_MAX_SUBPATTERNS);
+	rc = pcre_exec(re, extra, subject, (int)strlen(subject), 0, 0, ovector, REGEX_MAX_SUBPATTERNS);
 
 	if (rc < 0)
 	{
@@ -212,7 +311,7 @@ int RegEx::MatchAll(const char *str)
 
 	while (1)
 	{
-		rr = pcre_exec(re, NULL, subject, (int)subjectLen, startOffset, exoptions | notEmpty, ovector, REGEX_MAX_SUBPATTERNS);
+		rr = pcre_exec(re, extra, subject, (int)subjectLen, startOffset, exoptions | notEmpty, ovector, REGEX_MAX_SUBPATTERNS);
 
 		/**
 		 * The string was already proved to be valid UTF-8
@@ -821,3 +920,84 @@ int RegEx::Replace(char *text, size_t textMaxLen, const char *replace, size_t re
 	 */
 	return total;
 }
+
+RegExCache::RegExCache()
+{
+	mUseCount = 0;
+}
+
+RegExCache::~RegExCache()
+{
+	Clear();
+}
+
+void RegExCache::Clear()
+{
+	for (StringHashMap<CacheEntry>::iterator iter = mEntries.iter(); !iter.empty(); iter.next())
+	{
+		(*iter).value.code->Release();
+	}
+
+	mEntries.clear();
+	mUseCount = 0;
+}
+
+RegExCode *RegExCache::Get(const char *pattern, int iFlags, const char **error, int *errorOffset)
+{
+	char key[4096];
+	size_t length = ke::SafeSprintf(key, sizeof(key), "%x:%s", iFlags, pattern);
+
+	/**
+	 * Patterns too long for the key are just not cached.
+	 */
+	if (length >= sizeof(key) - 1)
+	{
+		return RegExCode::Compile(pattern, iFlags, error, errorOffset);
+	}
+
+	StringHashMap<CacheEntry>::Result r = mEntries.find(key);
+
+	if (r.found())
+	{
+		r->value.lastUse = ++mUseCount;
+		r->value.code->AddRef();
+
+		return r->value.code;
+	}
+
+	RegExCode *code = RegExCode::Compile(pattern, iFlags, error, errorOffset);
+
+	if (code == NULL)
+	{
+		return NULL;
+	}
+
+	if (mEntries.elements() >= REGEX_CACHE_SIZE)
+	{
+		ke::AString oldest;
+		unsigned int lastUse = 0xFFFFFFFF;
+
+		for (StringHashMap<CacheEntry>::iterator iter = mEntries.iter(); !iter.empty(); iter.next())
+		{
+			if ((*iter).value.lastUse < lastUse)
+			{
+				lastUse = (*iter).value.lastUse;
+				oldest = (*iter).key;
+			}
+		}
+
+		StringHashMap<CacheEntry>::Result old = mEntries.find(oldest.chars());
+
+		old->value.code->Release();
+		mEntries.remove(old);
+	}
+
+	CacheEntry entry;
+	entry.code = code;
+	entry.lastUse = ++mUseCount;
+
+	code->AddRef();
+	mEntries.insert(key, entry);
+
+	return code;
+}
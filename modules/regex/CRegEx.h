@@ -16,6 +16,7 @@
  
 #include <amtl/am-vector.h>
 #include <amtl/am-string.h>
+#include <sm_stringhashmap.h>
 
 /**
  * Maximum number of sub-patterns, here 50 (this should be a multiple of 3).
@@ -29,6 +30,35 @@
 #define REGEX_FORMAT_NOCOPY    1  // The sections that do not match the regular expression are not copied when replacing matches.
 #define REGEX_FORMAT_FIRSTONLY 2  // Only the first occurrence of a regular expression is replaced.
 
+/**
+ * Number of patterns regex_match and regex_match_all keep compiled.
+ */
+#define REGEX_CACHE_SIZE 64
+
+/**
+ * A compiled and studied (JIT when available) pattern. It is shared between
+ * the pattern cache and the handles regex_match* return, hence the refcount.
+ */
+class RegExCode
+{
+public:
+	static RegExCode *Compile(const char *pattern, int iFlags, const char **error, int *errorOffset);
+	static void FreeJitStack();
+
+	void AddRef();
+	void Release();
+
+public:
+	pcre *re;
+	pcre_extra *extra;
+
+private:
+	RegExCode();
+	~RegExCode();
+
+	unsigned int mRefs;
+};
+
 class RegEx
 {
 public:
@@ -49,6 +79,7 @@ public:
 
 	int Compile(const char *pattern, const char* flags = NULL);
 	int Compile(const char *pattern, int iFlags);
+	void Attach(RegExCode *code);
 	int Match(const char *str);
 	int MatchAll(const char *str);
 	int Replace(char *text, size_t text_maxlen, const char *replace, size_t replaceLen, int flags = 0);
@@ -56,13 +87,20 @@ public:
 	const char *GetSubstring(size_t start, char buffer[], size_t max, size_t *outlen = NULL);
 	void MakeSubpatternsTable(int numSubpatterns);
 
+	static int ParseFlags(const char *flags);
+
 public:
 	int mErrorOffset;
 	const char *mError;
 	int Count() { return mSubStrings.length(); }
 
 private:
+	void UseCode(RegExCode *code);
+
+private:
+	RegExCode *mCode;
 	pcre *re;
+	pcre_extra *extra;
 	bool mFree;
 	int ovector[REGEX_MAX_SUBPATTERNS];
 	char *subject;
@@ -72,5 +110,30 @@ private:
 	int mNumSubpatterns;
 };
 
+/**
+ * Patterns compiled by regex_match and regex_match_all, keyed by pattern and
+ * flags. Least recently used ones are dropped past REGEX_CACHE_SIZE.
+ */
+class RegExCache
+{
+public:
+	RegExCache();
+	~RegExCache();
+
+	// Returns a new reference, NULL and the pcre error if it does not compile.
+	RegExCode *Get(const char *pattern, int iFlags, const char **error, int *errorOffset);
+	void Clear();
+
+private:
+	struct CacheEntry
+	{
+		RegExCode *code;
+		unsigned int lastUse;
+	};
+
+	StringHashMap<CacheEntry> mEntries;
+	unsigned int mUseCount;
+};
+
 #endif //_INCLUDE_CREGEX_H
 
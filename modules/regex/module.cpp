@@ -20,6 +20,7 @@
 #include "utils.h"
 
 ke::Vector<RegEx *> PEL;
+RegExCache PatternCache;
 
 int GetPEL()
 {
@@ -87,7 +88,7 @@ cell match(AMX *amx, cell *params, bool all)
 
 	char *flags = NULL;
 	cell *errorCode;
-	int result = 0;
+	int iFlags;
 
 	if (!all)
 	{
@@ -96,23 +97,29 @@ cell match(AMX *amx, cell *params, bool all)
 			flags = MF_GetAmxString(amx, params[6], 2, &len);
 		}
 
-		result = x->Compile(regex, flags);
+		iFlags = RegEx::ParseFlags(flags);
 		errorCode = MF_GetAmxAddr(amx, params[3]);
 	}
 	else
 	{
-		result = x->Compile(regex, params[3]);
+		iFlags = params[3];
 		errorCode = MF_GetAmxAddr(amx, params[6]);
 	}
 
-	if (!result)
+	/* patterns are usually the same few filters over and over */
+	const char *err = NULL;
+	int errorOffset = 0;
+	RegExCode *code = PatternCache.Get(regex, iFlags, &err, &errorOffset);
+
+	if (code == NULL)
 	{
-		const char *err = x->mError;
-		*errorCode = x->mErrorOffset;
+		*errorCode = errorOffset;
 		MF_SetAmxString(amx, params[4], err ? err : "unknown", params[5]);
 		return -1;
 	}
 
+	x->Attach(code);
+
 	int e;
 
 	if (all)
@@ -333,4 +340,7 @@ void OnAmxxDetach()
 	}
 
 	PEL.clear();
+
+	PatternCache.Clear();
+	RegExCode::FreeJitStack();
 }
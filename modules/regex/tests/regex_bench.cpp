@@ -0,0 +1,374 @@
+// vim: set ts=4 sw=4 tw=99 noet:
+//
+// AMX Mod X, based on AMX Mod by Aleksander Naszko ("OLO").
+// Copyright (C) The AMX Mod X Development Team.
+//
+// This software is licensed under the GNU General Public License, version 3 or higher.
+// Additional exceptions apply. For full license details, see LICENSE.txt or visit:
+//     https://alliedmods.net/amxmodx-license
+
+//
+// Regular Expressions Module
+//
+
+// Typical chat filter patterns over chat lines:
+// - RegEx::Match and MatchAll must agree with the plain pcre interpreter.
+// - pcre_exec is timed with the interpreter and with the JIT study.
+// - regex_match's way to a compiled pattern is timed, compiling it on every
+//   call and looking it up in RegExCache.
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+// CRegEx.cpp and utils.cpp never call into the module API
+#define __AMXXMODULE_H__
+
+#include "../CRegEx.cpp"
+#include "../utils.cpp"
+
+struct ChatFilter
+{
+	const char *name;
+	const char *pattern;
+	const char *flags;
+};
+
+static const ChatFilter Filters[] =
+{
+	{ "swear words",      "\\b(f+u+c+k+|s+h+i+t+|b+i+t+c+h+)(ing|er|s)?\\b",           "i" },
+	{ "insults",          "\\b(idiot|stupid|n[o0]{2,}b|l[o0]ser)s?\\b",                "i" },
+	{ "links",            "(https?://|www\\.)[^\\s]+",                                 "i" },
+	{ "domains",          "\\b[a-z0-9-]{2,}\\.(com|net|org|ru|de|eu|info)\\b",         "i" },
+	{ "server address",   "\\b\\d{1,3}(\\.\\d{1,3}){3}(:\\d{2,5})?\\b",                "" },
+	{ "steam id",         "STEAM_[0-5]:[01]:\\d+",                                     "" },
+	{ "chat commands",    "^\\s*[/!.](rtv|nominate|votemap|admin|menu)\\b\\s*(\\S*)",  "i" },
+	{ "caps spam",        "^(?=(?:[^A-Z]*[A-Z]){8})[^a-z]+$",                          "" },
+	{ "repeated letters", "(.)\\1{5,}",                                                "" },
+	{ "color codes",      "[\\x01-\\x04]",                                             "" },
+	{ "key value",        "(?<key>\\w+)\\s*=\\s*(?<value>\"[^\"]*\"|\\S+)",            "" },
+	{ "blank message",    "^\\s*$",                                                    "" },
+};
+
+static const char *Messages[] =
+{
+	"gg",
+	"hello everyone",
+	"rtv",
+	"/rtv",
+	"!nominate de_dust2",
+	"  .admin",
+	"WHO IS CAMPING AT B?? COME ON",
+	"noooooooooooooob",
+	"you are such an idiot lol",
+	"f u c k this map",
+	"fuuuuuck",
+	"join my server 192.168.100.12:27015 best mod",
+	"visit www.example-clan.com for more info",
+	"http://example.org/forum/index.php?topic=1234 new plugin released",
+	"my steam STEAM_0:1:12345678 add me",
+	"\x04[Server]\x01 Welcome",
+	"sv_gravity = 800 mp_timelimit=\"25\"",
+	"   ",
+	"",
+	"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. "
+	"Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo",
+};
+
+#define FILTER_COUNT  (sizeof(Filters) / sizeof(Filters[0]))
+#define MESSAGE_COUNT (sizeof(Messages) / sizeof(Messages[0]))
+
+static int Failures;
+
+// Same as RegEx::MatchAll with the plain interpreter, appends every substring
+// offset pair and returns the number of matches.
+static int InterpreterMatchAll(pcre *re, pcre_extra *extra, const char *subject, ke::Vector<int> &offsets)
+{
+	int ovector[REGEX_MAX_SUBPATTERNS];
+	int length = (int)strlen(subject);
+	int startOffset = 0;
+	int notEmpty = 0;
+	int matches = 0;
+	int rc;
+
+	while (1)
+	{
+		rc = pcre_exec(re, extra, subject, length, startOffset, notEmpty, ovector, REGEX_MAX_SUBPATTERNS);
+
+		if (rc == 0)
+		{
+			rc = REGEX_MAX_SUBPATTERNS / 3;
+		}
+
+		if (rc > 0)
+		{
+			matches++;
+
+			for (int s = 0; s < rc; s++)
+			{
+				offsets.append(ovector[2 * s]);
+				offsets.append(ovector[2 * s + 1]);
+			}
+		}
+		else if (rc == PCRE_ERROR_NOMATCH)
+		{
+			if (notEmpty && startOffset < length)
+			{
+				ovector[0] = startOffset;
+				ovector[1] = startOffset + 1;
+			}
+			else
+			{
+				break;
+			}
+		}
+		else
+		{
+			return -1;
+		}
+
+		notEmpty = (ovector[1] == ovector[0]) ? PCRE_NOTEMPTY | PCRE_ANCHORED : 0;
+		startOffset = ovector[1];
+	}
+
+	return matches;
+}
+
+// Compares what RegEx reports with the offsets the interpreter found.
+static bool SameSubstrings(RegEx &regex, const char *subject, ke::Vector<int> &offsets)
+{
+	char found[256], expected[256];
+
+	if ((size_t)regex.Count() * 2 != offsets.length())
+		return false;
+
+	for (size_t i = 0; i < offsets.length() / 2; i++)
+	{
+		regex.GetSubstring(i, found, sizeof(found) - 1);
+		getSubstring(const_cast<char *>(subject), offsets[2 * i], offsets[2 * i + 1], expected, sizeof(expected) - 1, NULL);
+
+		if (strcmp(found, expected))
+			return false;
+	}
+
+	return true;
+}
+
+static void CheckFilter(const ChatFilter &filter, RegExCode *code, pcre_extra *interpreter)
+{
+	int ovector[REGEX_MAX_SUBPATTERNS];
+	int hits = 0;
+
+	for (size_t m = 0; m < MESSAGE_COUNT; m++)
+	{
+		const char *message = Messages[m];
+		const int length = (int)strlen(message);
+		ke::Vector<int> offsets;
+		RegEx regex;
+
+		code->AddRef();
+		regex.Attach(code);
+
+		int rc = pcre_exec(code->re, interpreter, message, length, 0, 0, ovector, REGEX_MAX_SUBPATTERNS);
+		int matched = regex.Match(message);
+
+		if (rc > 0)
+		{
+			for (int s = 0; s < rc; s++)
+			{
+				offsets.append(ovector[2 * s]);
+				offsets.append(ovector[2 * s + 1]);
+			}
+		}
+
+		if (matched != (rc > 0 ? 1 : (rc == PCRE_ERROR_NOMATCH ? 0 : -1)) || (matched > 0 && !SameSubstrings(regex, message, offsets)))
+		{
+			printf("FAIL: %s, match \"%s\": %d vs %d\n", filter.name, message, matched, rc);
+			Failures++;
+		}
+
+		hits += (matched > 0);
+
+		offsets.clear();
+		rc = InterpreterMatchAll(code->re, interpreter, message, offsets);
+		matched = regex.MatchAll(message);
+
+		if (matched != (rc > 0 ? 1 : rc) || (matched > 0 && !SameSubstrings(regex, message, offsets)))
+		{
+			printf("FAIL: %s, match all \"%s\": %d vs %d\n", filter.name, message, matched, rc);
+			Failures++;
+		}
+	}
+
+	printf("%-18s %2d/%d lines\n", filter.name, hits, (int)MESSAGE_COUNT);
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static double Elapsed(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// What regex_match does for one line: get the pattern, attach it and match.
+// Returns the number of lines matched, -1 if a pattern does not compile.
+static long MatchEveryLine(RegExCache *cache, int rounds)
+{
+	const char *error = NULL;
+	int errorOffset = 0;
+	long hits = 0;
+
+	for (int r = 0; r < rounds; r++)
+	{
+		for (size_t f = 0; f < FILTER_COUNT; f++)
+		{
+			const int flags = RegEx::ParseFlags(Filters[f].flags);
+
+			for (size_t m = 0; m < MESSAGE_COUNT; m++)
+			{
+				RegEx regex;
+
+				if (cache)
+				{
+					RegExCode *code = cache->Get(Filters[f].pattern, flags, &error, &errorOffset);
+
+					if (code == NULL)
+						return -1;
+
+					regex.Attach(code);
+				}
+				else if (!regex.Compile(Filters[f].pattern, flags))
+				{
+					return -1;
+				}
+
+				hits += regex.Match(Messages[m]) > 0;
+			}
+		}
+	}
+
+	return hits;
+}
+
+int main()
+{
+	RegExCode *codes[FILTER_COUNT];
+	pcre_extra *interpreters[FILTER_COUNT];
+	int jitted = 0;
+	size_t f, m;
+
+	for (f = 0; f < FILTER_COUNT; f++)
+	{
+		const char *error = NULL;
+		int errorOffset = 0;
+
+		codes[f] = RegExCode::Compile(Filters[f].pattern, RegEx::ParseFlags(Filters[f].flags), &error, &errorOffset);
+
+		if (codes[f] == NULL)
+		{
+			printf("FAIL: %s does not compile: %s at %d\n", Filters[f].name, error, errorOffset);
+			return 1;
+		}
+
+		// same study, without JIT: the interpreter with the start optimizations
+		interpreters[f] = pcre_study(codes[f]->re, 0, &error);
+
+		int jit = 0;
+		if (codes[f]->extra && pcre_fullinfo(codes[f]->re, codes[f]->extra, PCRE_INFO_JIT, &jit) == 0 && jit)
+		{
+			jitted++;
+		}
+
+		CheckFilter(Filters[f], codes[f], interpreters[f]);
+	}
+
+	printf("%d/%d patterns JIT compiled\n", jitted, (int)FILTER_COUNT);
+
+	// every filter over every line, as a chat filter plugin does on each say
+	const int rounds = 2000;
+	int ovector[REGEX_MAX_SUBPATTERNS];
+	long hits = 0;
+	int lengths[MESSAGE_COUNT];
+
+	for (m = 0; m < MESSAGE_COUNT; m++)
+	{
+		lengths[m] = (int)strlen(Messages[m]);
+	}
+
+	Clock::time_point start = Clock::now();
+	for (int r = 0; r < rounds; r++)
+	{
+		for (f = 0; f < FILTER_COUNT; f++)
+		{
+			for (m = 0; m < MESSAGE_COUNT; m++)
+			{
+				hits += pcre_exec(codes[f]->re, interpreters[f], Messages[m], lengths[m], 0, 0, ovector, REGEX_MAX_SUBPATTERNS) > 0;
+			}
+		}
+	}
+	const double interpreter = Elapsed(start);
+
+	start = Clock::now();
+	for (int r = 0; r < rounds; r++)
+	{
+		for (f = 0; f < FILTER_COUNT; f++)
+		{
+			for (m = 0; m < MESSAGE_COUNT; m++)
+			{
+				hits -= pcre_exec(codes[f]->re, codes[f]->extra, Messages[m], lengths[m], 0, 0, ovector, REGEX_MAX_SUBPATTERNS) > 0;
+			}
+		}
+	}
+	const double jit = Elapsed(start);
+
+	const double matches = (double)rounds * FILTER_COUNT * MESSAGE_COUNT;
+	printf("interpreter %.3f us/match  jit %.3f us/match  (%.1fx)\n", interpreter / matches, jit / matches, interpreter / jit);
+
+	if (hits != 0)
+	{
+		printf("FAIL: benchmark results differ\n");
+		Failures++;
+	}
+
+	// compiling with JIT dominates, fewer rounds are enough to see it
+	const int lookupRounds = 50;
+	RegExCache cache;
+
+	start = Clock::now();
+	const long compiledHits = MatchEveryLine(NULL, lookupRounds);
+	const double compiled = Elapsed(start);
+
+	start = Clock::now();
+	const long cachedHits = MatchEveryLine(&cache, lookupRounds);
+	const double cached = Elapsed(start);
+
+	const double calls = (double)lookupRounds * FILTER_COUNT * MESSAGE_COUNT;
+	printf("regex_match: compile per call %.3f us/call  RegExCache %.3f us/call  (%.1fx)\n", compiled / calls, cached / calls, compiled / cached);
+
+	if (compiledHits < 0 || compiledHits != cachedHits)
+	{
+		printf("FAIL: cached results differ: %ld vs %ld\n", cachedHits, compiledHits);
+		Failures++;
+	}
+
+	cache.Clear();
+
+	for (f = 0; f < FILTER_COUNT; f++)
+	{
+		if (interpreters[f])
+			pcre_free_study(interpreters[f]);
+
+		codes[f]->Release();
+	}
+
+	RegExCode::FreeJitStack();
+
+	if (Failures)
+	{
+		printf("%d check(s) failed\n", Failures);
+		return 1;
+	}
+
+	printf("all checks passed\n");
+	return 0;
+}
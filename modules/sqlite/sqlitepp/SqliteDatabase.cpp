@@ -24,7 +24,7 @@
 using namespace SourceMod;
 
 SqliteDatabase::SqliteDatabase(sqlite3 *sql, SqliteDriver *drvr) : 
-	m_pSql(sql), m_pParent(drvr)
+	m_pSql(sql), m_pParent(drvr), m_StmtHead(NULL), m_StmtTail(NULL), m_StmtCount(0)
 {
 }
 
@@ -37,11 +37,110 @@ void SqliteDatabase::Disconnect()
 {
 	if (m_pSql)
 	{
+		ClearStatements();
 		sqlite3_close(m_pSql);
 		m_pSql = NULL;
 	}
 }
 
+void SqliteDatabase::ClearStatements()
+{
+	CachedStatement *entry = m_StmtHead;
+
+	while (entry)
+	{
+		CachedStatement *next = entry->next;
+		sqlite3_finalize(entry->stmt);
+		delete entry;
+		entry = next;
+	}
+
+	m_Statements.clear();
+	m_StmtHead = m_StmtTail = NULL;
+	m_StmtCount = 0;
+}
+
+/**
+ * Returns a reset statement for a query made of a single statement, prepared
+ * the first time it is seen.  NULL if the query can't be prepared or holds
+ * more than one statement, sqlite3_get_table is used for those.
+ * Must be called with the connection mutex held.
+ */
+sqlite3_stmt *SqliteDatabase::GetStatement(const char *query)
+{
+	CachedStatement *entry;
+
+	if (m_Statements.retrieve(query, &entry))
+	{
+		if (entry != m_StmtHead)
+		{
+			entry->prev->next = entry->next;
+			if (entry->next)
+				entry->next->prev = entry->prev;
+			else
+				m_StmtTail = entry->prev;
+
+			entry->prev = NULL;
+			entry->next = m_StmtHead;
+			m_StmtHead->prev = entry;
+			m_StmtHead = entry;
+		}
+
+		return entry->stmt;
+	}
+
+	sqlite3_stmt *stmt;
+	const char *tail = NULL;
+
+	if (sqlite3_prepare_v2(m_pSql, query, -1, &stmt, &tail) != SQLITE_OK || !stmt)
+	{
+		return NULL;
+	}
+
+	while (tail && (*tail == ';' || *tail == ' ' || *tail == '\t' || *tail == '\r' || *tail == '\n'))
+	{
+		tail++;
+	}
+
+	if (tail && *tail)
+	{
+		sqlite3_finalize(stmt);
+		return NULL;
+	}
+
+	if (m_StmtCount >= SQLITE_STATEMENT_CACHE)
+	{
+		CachedStatement *last = m_StmtTail;
+
+		m_StmtTail = last->prev;
+		m_StmtTail->next = NULL;
+
+		m_Statements.remove(last->query.chars());
+		sqlite3_finalize(last->stmt);
+		delete last;
+
+		m_StmtCount--;
+	}
+
+	entry = new CachedStatement;
+	entry->query = query;
+	entry->stmt = stmt;
+	entry->prev = NULL;
+	entry->next = m_StmtHead;
+
+	if (m_StmtHead)
+		m_StmtHead->prev = entry;
+	else
+		m_StmtTail = entry;
+
+	m_StmtHead = entry;
+	m_StmtCount++;
+
+	m_Statements.insert(query, entry);
+
+	return stmt;
+}
+
 void SqliteDatabase::FreeHandle()
 {
 	delete this;
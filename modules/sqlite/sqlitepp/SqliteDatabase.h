@@ -16,6 +16,10 @@
 
 #include "SqliteHeaders.h"
 #include "SqliteDriver.h"
+#include <amtl/am-string.h>
+#include <sm_stringhashmap.h>
+
+#define SQLITE_STATEMENT_CACHE	64
 
 namespace SourceMod
 {
@@ -24,6 +28,14 @@ namespace SourceMod
 	class SqliteDatabase : public IDatabase
 	{
 		friend class SqliteQuery;
+	private:
+		struct CachedStatement
+		{
+			ke::AString query;
+			sqlite3_stmt *stmt;
+			CachedStatement *prev;
+			CachedStatement *next;
+		};
 	public:
 		SqliteDatabase(sqlite3 *sql, SqliteDriver *drvr);
 		~SqliteDatabase();
@@ -38,9 +50,17 @@ namespace SourceMod
 		bool SetCharacterSet(const char *characterset);
 	private:
 		void Disconnect();
+		sqlite3_stmt *GetStatement(const char *query);
+		void ClearStatements();
 	private:
 		sqlite3 *m_pSql;
 		SqliteDriver *m_pParent;
+
+		// prepared statements by query text, most recently used first
+		StringHashMap<CachedStatement *> m_Statements;
+		CachedStatement *m_StmtHead;
+		CachedStatement *m_StmtTail;
+		size_t m_StmtCount;
 	};
 };
 
@@ -16,6 +16,7 @@
 #include "SqliteDatabase.h"
 #include "SqliteResultSet.h"
 #include <amtl/am-string.h>
+#include <amtl/am-vector.h>
 
 using namespace SourceMod;
 
@@ -81,6 +82,119 @@ const char *SqliteQuery::GetQueryString()
 }
 
 bool SqliteQuery::ExecuteR(QueryInfo *info, char *error, size_t maxlength)
+{
+	// the statement cache isn't shared with another thread using this connection
+	sqlite3_mutex *mutex = sqlite3_db_mutex(m_pDatabase->m_pSql);
+	sqlite3_mutex_enter(mutex);
+
+	bool res;
+	sqlite3_stmt *stmt = m_pDatabase->GetStatement(m_QueryString);
+
+	if (stmt)
+	{
+		res = ExecuteStatement(stmt, info, error, maxlength);
+	} else {
+		res = ExecuteTable(info, error, maxlength);
+	}
+
+	sqlite3_mutex_leave(mutex);
+
+	return res;
+}
+
+bool SqliteQuery::ExecuteStatement(sqlite3_stmt *stmt, QueryInfo *info, char *error, size_t maxlength)
+{
+	int err;
+	int cols = sqlite3_column_count(stmt);
+	int rows = 0;
+	ke::Vector<char> data;
+	ke::Vector<ptrdiff_t> offsets;		// into data, -1 for NULL
+
+	for (int i = 0; i < cols; i++)
+	{
+		const char *name = sqlite3_column_name(stmt, i);
+		size_t len = strlen(name) + 1;
+		size_t at = data.length();
+
+		offsets.append(at);
+		data.resize(at + len);
+		memcpy(&data[at], name, len);
+	}
+
+	while ((err = sqlite3_step(stmt)) == SQLITE_ROW)
+	{
+		for (int i = 0; i < cols; i++)
+		{
+			const char *value = reinterpret_cast<const char *>(sqlite3_column_text(stmt, i));
+
+			if (!value)
+			{
+				offsets.append(-1);
+				continue;
+			}
+
+			size_t len = sqlite3_column_bytes(stmt, i) + 1;
+			size_t at = data.length();
+
+			offsets.append(at);
+			data.resize(at + len);
+			memcpy(&data[at], value, len);
+		}
+
+		rows++;
+	}
+
+	if (err != SQLITE_DONE)
+	{
+		err = sqlite3_reset(stmt);
+
+		if (error && maxlength)
+		{
+			ke::SafeSprintf(error, maxlength, "%s", sqlite3_errmsg(m_pDatabase->m_pSql));
+		}
+		info->affected_rows = 0;
+		info->errorcode = err;
+		info->rs = NULL;
+		info->success = false;
+
+		return false;
+	}
+
+	sqlite3_reset(stmt);
+
+	info->affected_rows = sqlite3_changes(m_pDatabase->m_pSql);
+	info->errorcode = 0;
+	info->success = true;
+	info->rs = NULL;
+
+	// sqlite3_get_table reports no columns when there are no rows, stick to that
+	if (cols && rows)
+	{
+		size_t table = offsets.length() * sizeof(char *);
+		char **results = (char **)malloc(table + data.length());
+		char *strings = (char *)results + table;
+
+		memcpy(strings, data.buffer(), data.length());
+
+		for (size_t i = 0; i < offsets.length(); i++)
+		{
+			results[i] = (offsets[i] == -1) ? NULL : strings + offsets[i];
+		}
+
+		SqliteResults res;
+		res.cols = cols;
+		res.rows = rows;
+		res.results = results;
+		res.block = true;
+
+		SqliteResultSet *pRes = new SqliteResultSet(res);
+		info->rs = static_cast<IResultSet *>(pRes);
+	}
+
+	return true;
+}
+
+bool SqliteQuery::ExecuteTable(QueryInfo *info, char *error, size_t maxlength)
 {
 	int err;
 	char *errmsg;
@@ -109,6 +223,7 @@ bool SqliteQuery::ExecuteR(QueryInfo *info, char *error, size_t maxlength)
 			data.cols = cols;
 			data.rows = rows;
 			data.results = results;
+			data.block = false;
 
 			SqliteResultSet *pRes = new SqliteResultSet(data);
 			info->rs = static_cast<IResultSet *>(pRes);
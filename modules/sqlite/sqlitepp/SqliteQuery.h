@@ -29,6 +29,7 @@ namespace SourceMod
 			char **results;
 			int rows;
 			int cols;
+			bool block;		// results is one malloc'd block, not from sqlite3_get_table
 		};
 	public:
 		SqliteQuery(SqliteDatabase *db, const char *query);
@@ -39,6 +40,9 @@ namespace SourceMod
 		bool ExecuteR(QueryInfo *info, char *error, size_t maxlength);
 		bool Execute2(QueryInfo *info, char *error, size_t maxlength);
 		const char *GetQueryString();
+	private:
+		bool ExecuteTable(QueryInfo *info, char *error, size_t maxlength);
+		bool ExecuteStatement(sqlite3_stmt *stmt, QueryInfo *info, char *error, size_t maxlength);
 	private:
 		SqliteDatabase *m_pDatabase;
 		SqliteResultSet *m_LastRes;
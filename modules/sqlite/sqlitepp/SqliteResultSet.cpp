@@ -20,6 +20,7 @@ using namespace SourceMod;
 SqliteResultSet::SqliteResultSet(SqliteQuery::SqliteResults &res)
 {
 	m_pResults = res.results;
+	m_Block = res.block;
 	m_Columns = res.cols;
 	m_Rows = res.rows;
 
@@ -31,7 +32,10 @@ SqliteResultSet::~SqliteResultSet()
 {
 	if (m_pResults)
 	{
-		sqlite3_free_table(m_pResults);
+		if (m_Block)
+			free(m_pResults);
+		else
+			sqlite3_free_table(m_pResults);
 		m_pResults = NULL;
 	}
 }
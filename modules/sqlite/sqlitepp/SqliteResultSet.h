@@ -57,6 +57,7 @@ namespace SourceMod
 		const char *GetStringSafe(unsigned int columnId);
 	private:
 		char **m_pResults;
+		bool m_Block;
 		unsigned int m_Columns;
 		unsigned int m_Rows;
 		unsigned int m_CurRow;
@@ -15,6 +15,7 @@
 #include "sqlite_header.h"
 #include "threading.h"
 #include <amtl/am-string.h>
+#include <sm_stringhashmap.h>
 
 MainThreader g_Threader;
 ThreadWorker *g_pWorker = NULL;
@@ -24,6 +25,37 @@ CStack<MysqlThread *> g_ThreadQueue;
 CStack<MysqlThread *> g_FreeThreads;
 float g_lasttime = 0.0f;
 
+// Connections used by threaded queries, keyed by database path. They belong to
+// the worker thread and are only closed by the main thread once it has stopped.
+StringHashMap<IDatabase *> g_ThreadDatabases;
+
+static IDatabase *GetThreadDatabase(DatabaseInfo *info, int *errcode, char *error, size_t maxlength)
+{
+	IDatabase *pDatabase;
+
+	if (g_ThreadDatabases.retrieve(info->database, &pDatabase))
+	{
+		return pDatabase;
+	}
+
+	if ((pDatabase = g_Sqlite.Connect(info, errcode, error, maxlength)) != NULL)
+	{
+		g_ThreadDatabases.insert(info->database, pDatabase);
+	}
+
+	return pDatabase;
+}
+
+static void CloseThreadDatabases()
+{
+	for (StringHashMap<IDatabase *>::iterator iter = g_ThreadDatabases.iter(); !iter.empty(); iter.next())
+	{
+		(*iter).value->FreeHandle();
+	}
+
+	g_ThreadDatabases.clear();
+}
+
 void ShutdownThreading()
 {
 	if (g_pWorker)
@@ -35,6 +67,8 @@ void ShutdownThreading()
 		g_pWorker = NULL;
 	}
 
+	CloseThreadDatabases();
+
 	g_QueueLock->Lock();
 	while (!g_ThreadQueue.empty())
 	{
@@ -99,12 +133,161 @@ static cell AMX_NATIVE_CALL SQL_ThreadQuery(AMX *amx, cell *params)
 	return 1;
 }
 
+void FreeTransaction(void *p, unsigned int num)
+{
+	SQL_Transaction *txn = (SQL_Transaction *)p;
+
+	// the worker or the handler still use it, the thread deletes it when done
+	if (txn->executing)
+	{
+		txn->freed = true;
+		return;
+	}
+
+	delete txn;
+}
+
+SQL_Transaction::~SQL_Transaction()
+{
+	for (size_t i = 0; i < queries.length(); i++)
+	{
+		delete queries[i];
+	}
+}
+
+//native Handle:SQL_CreateTransaction();
+static cell AMX_NATIVE_CALL SQL_CreateTransaction(AMX *amx, cell *params)
+{
+	SQL_Transaction *txn = new SQL_Transaction();
+
+	return MakeHandle(txn, Handle_Transaction, FreeTransaction);
+}
+
+//native SQL_AddQuery(Handle:txn, const query[]);
+static cell AMX_NATIVE_CALL SQL_AddQuery(AMX *amx, cell *params)
+{
+	SQL_Transaction *txn = (SQL_Transaction *)GetHandle(params[1], Handle_Transaction);
+	if (!txn)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid transaction handle: %d", params[1]);
+		return -1;
+	}
+
+	if (txn->executing)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Transaction %d is already executing", params[1]);
+		return -1;
+	}
+
+	int len;
+	const char *query = MF_GetAmxString(amx, params[2], 0, &len);
+
+	TransactionQuery *tq = new TransactionQuery();
+	tq->amxinfo.opt_ptr = new char[len + 1];
+	strcpy(tq->amxinfo.opt_ptr, query);
+
+	txn->queries.append(tq);
+
+	return static_cast<cell>(txn->queries.length()) - 1;
+}
+
+//public TransactionHandler(failstate, Handle:txn, error[], errnum, failIndex, data[], size, Float:queuetime)
+//native SQL_ExecuteTransaction(Handle:db_tuple, Handle:txn, const handler[], const data[]="", dataSize=0);
+static cell AMX_NATIVE_CALL SQL_ExecuteTransaction(AMX *amx, cell *params)
+{
+	if (!g_pWorker)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Thread worker was unable to start.");
+		return 0;
+	}
+
+	SQL_Connection *cn = (SQL_Connection *)GetHandle(params[1], Handle_Connection);
+	if (!cn)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid info tuple handle: %d", params[1]);
+		return 0;
+	}
+
+	SQL_Transaction *txn = (SQL_Transaction *)GetHandle(params[2], Handle_Transaction);
+	if (!txn)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid transaction handle: %d", params[2]);
+		return 0;
+	}
+
+	if (txn->executing)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Transaction %d is already executing", params[2]);
+		return 0;
+	}
+
+	int len;
+	const char *handler = MF_GetAmxString(amx, params[3], 0, &len);
+	int fwd = MF_RegisterSPForwardByName(amx, handler, FP_CELL, FP_CELL, FP_STRING, FP_CELL, FP_CELL, FP_ARRAY, FP_CELL, FP_CELL, FP_DONE);
+	if (fwd < 1)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Function not found: %s", handler);
+		return 0;
+	}
+
+	MysqlThread *kmThread;
+	g_QueueLock->Lock();
+	if (g_FreeThreads.empty())
+	{
+		kmThread = new MysqlThread();
+	} else {
+		kmThread = g_FreeThreads.front();
+		g_FreeThreads.pop();
+	}
+	g_QueueLock->Unlock();
+
+	txn->executing = true;
+
+	kmThread->SetInfo(cn->db);
+	kmThread->SetForward(fwd);
+	kmThread->SetQuery("");
+	kmThread->SetTransaction(txn, params[2]);
+	kmThread->SetCellData(MF_GetAmxAddr(amx, params[4]), (ucell)params[5]);
+
+	g_pWorker->MakeThread(kmThread);
+
+	return 1;
+}
+
+//native Handle:SQL_GetTransactionResult(Handle:txn, index);
+static cell AMX_NATIVE_CALL SQL_GetTransactionResult(AMX *amx, cell *params)
+{
+	SQL_Transaction *txn = (SQL_Transaction *)GetHandle(params[1], Handle_Transaction);
+	if (!txn)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid transaction handle: %d", params[1]);
+		return 0;
+	}
+
+	if (!txn->inHandler)
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Transaction results are only available from its handler");
+		return 0;
+	}
+
+	if (params[2] < 0 || static_cast<size_t>(params[2]) >= txn->queries.length())
+	{
+		MF_LogError(amx, AMX_ERR_NATIVE, "Invalid query index %d (count: %d)", params[2], static_cast<int>(txn->queries.length()));
+		return 0;
+	}
+
+	return txn->queries[params[2]]->handle;
+}
+
 MysqlThread::MysqlThread()
 {
 	m_fwd = 0;
 	m_data = NULL;
 	m_datalen = 0;
 	m_maxdatalen = 0;
+	m_txn = NULL;
+	m_txnHandle = 0;
+	m_failIndex = -1;
 }
 
 MysqlThread::~MysqlThread()
@@ -148,6 +331,76 @@ void MysqlThread::SetInfo(const char *db)
 void MysqlThread::SetQuery(const char *query)
 {
 	m_query = query;
+	m_txn = NULL;
+}
+
+void MysqlThread::SetTransaction(SQL_Transaction *txn, unsigned int handle)
+{
+	m_txn = txn;
+	m_txnHandle = handle;
+}
+
+static bool RunSimpleQuery(IDatabase *pDatabase, const char *query, QueryInfo *info, char *error, size_t maxlength)
+{
+	IQuery *pQuery = pDatabase->PrepareQuery(query);
+	bool success = pQuery->Execute2(info, error, maxlength);
+	pQuery->FreeHandle();
+
+	return success;
+}
+
+void MysqlThread::RunTransaction(IDatabase *pDatabase)
+{
+	QueryInfo info;
+	char error[255];
+
+	m_failIndex = -1;
+
+	if (!RunSimpleQuery(pDatabase, "BEGIN", &m_qrInfo.amxinfo.info, m_qrInfo.amxinfo.error, 254))
+	{
+		m_qrInfo.query_success = false;
+		return;
+	}
+
+	for (size_t i = 0; i < m_txn->queries.length(); i++)
+	{
+		TransactionQuery *tq = m_txn->queries[i];
+
+		memset(&tq->amxinfo.info, 0, sizeof(QueryInfo));
+		tq->amxinfo.error[0] = '\0';
+
+		IQuery *pQuery = pDatabase->PrepareQuery(tq->amxinfo.opt_ptr);
+		bool success = pQuery->Execute2(&tq->amxinfo.info, tq->amxinfo.error, 254);
+
+		if (success && tq->amxinfo.info.rs)
+		{
+			tq->result.CopyFrom(tq->amxinfo.info.rs);
+			tq->amxinfo.info.rs = &tq->result;
+		}
+
+		pQuery->FreeHandle();
+
+		if (!success)
+		{
+			m_failIndex = static_cast<int>(i);
+			m_qrInfo.query_success = false;
+			m_qrInfo.amxinfo.info.errorcode = tq->amxinfo.info.errorcode;
+			strcpy(m_qrInfo.amxinfo.error, tq->amxinfo.error);
+
+			RunSimpleQuery(pDatabase, "ROLLBACK", &info, error, sizeof(error));
+			return;
+		}
+	}
+
+	if (!RunSimpleQuery(pDatabase, "COMMIT", &m_qrInfo.amxinfo.info, m_qrInfo.amxinfo.error, 254))
+	{
+		m_qrInfo.query_success = false;
+
+		RunSimpleQuery(pDatabase, "ROLLBACK", &info, error, sizeof(error));
+		return;
+	}
+
+	m_qrInfo.query_success = true;
 }
 
 void MysqlThread::RunThread(IThreadHandle *pHandle)
@@ -166,7 +419,20 @@ void MysqlThread::RunThread(IThreadHandle *pHandle)
 
 	m_qrInfo.queue_time = save_time;
 
-	IDatabase *pDatabase = g_Sqlite.Connect(&info, &m_qrInfo.amxinfo.info.errorcode, m_qrInfo.amxinfo.error, 254);
+	IDatabase *pDatabase = GetThreadDatabase(&info, &m_qrInfo.amxinfo.info.errorcode, m_qrInfo.amxinfo.error, 254);
+
+	if (m_txn)
+	{
+		m_qrInfo.connect_success = (pDatabase != NULL);
+
+		if (pDatabase)
+		{
+			RunTransaction(pDatabase);
+		}
+
+		return;
+	}
+
 	IQuery *pQuery = NULL;
 	if (!pDatabase)
 	{
@@ -196,17 +462,23 @@ void MysqlThread::RunThread(IThreadHandle *pHandle)
 		m_qrInfo.amxinfo.opt_ptr = new char[m_query.length() + 1];
 		strcpy(m_qrInfo.amxinfo.opt_ptr, m_query.chars());
 	}
-
-	if (pDatabase)
-	{
-		pDatabase->FreeHandle();
-		pDatabase = NULL;
-	}
 }
 
 void MysqlThread::Invalidate()
 {
 	m_atomicResult.FreeHandle();
+
+	if (m_txn)
+	{
+		m_txn->executing = false;
+
+		if (m_txn->freed)
+		{
+			delete m_txn;
+		}
+
+		m_txn = NULL;
+	}
 }
 
 void MysqlThread::OnTerminate(IThreadHandle *pHandle, bool cancel)
@@ -228,6 +500,53 @@ void NullFunc(void *ptr, unsigned int num)
 {
 }
 
+void MysqlThread::ExecuteTransaction(int state, cell data_addr, cell c_diff)
+{
+	size_t i;
+
+	// statement results are only handed out when everything was committed
+	if (state == 0)
+	{
+		for (i = 0; i < m_txn->queries.length(); i++)
+		{
+			m_txn->queries[i]->handle = MakeHandle(&m_txn->queries[i]->amxinfo, Handle_Query, NullFunc);
+		}
+	}
+
+	m_txn->inHandler = true;
+
+	MF_ExecuteForward(m_fwd,
+		(cell)state,
+		(cell)m_txnHandle,
+		state ? m_qrInfo.amxinfo.error : "",
+		state ? m_qrInfo.amxinfo.info.errorcode : (cell)0,
+		(cell)m_failIndex,
+		data_addr,
+		m_datalen,
+		c_diff);
+
+	m_txn->inHandler = false;
+
+	for (i = 0; i < m_txn->queries.length(); i++)
+	{
+		TransactionQuery *tq = m_txn->queries[i];
+
+		if (tq->handle)
+		{
+			FreeHandle(tq->handle);
+			tq->handle = 0;
+		}
+
+		tq->result.FreeHandle();
+	}
+
+	// the handle goes away with the transaction, Invalidate() deletes it
+	if (!m_txn->freed)
+	{
+		FreeHandle(m_txnHandle);
+	}
+}
+
 //public QueryHandler(state, Handle:query, error[], errnum, data[], size)
 void MysqlThread::Execute()
 {
@@ -248,6 +567,13 @@ void MysqlThread::Execute()
 	}
 	float diff = gpGlobals->time - m_qrInfo.queue_time;
 	cell c_diff = amx_ftoc(diff);
+
+	if (m_txn)
+	{
+		ExecuteTransaction(state, data_addr, c_diff);
+		return;
+	}
+
 	unsigned int hndl = MakeHandle(&m_qrInfo.amxinfo, Handle_Query, NullFunc);
 	if (state != 0)
 	{
@@ -367,19 +693,30 @@ void OnPluginsUnloading()
 	}
 
 	g_QueueLock->Unlock();
+
+	CloseThreadDatabases();
 }
 
 /***********************
  * ATOMIC RESULT STUFF *
  ***********************/
 
+// Arenas above this size are given back once the result is freed, so a single
+// huge SELECT does not pin its memory to the worker for the rest of the map.
+#define ARENA_KEEP_SIZE		(256 * 1024)
+
 AtomicResult::AtomicResult()
 {
 	m_IsFree = true;
 	m_CurRow = 1;
 	m_RowCount = 0;
-	m_Table = NULL;
+	m_FieldCount = 0;
+	m_Cells = NULL;
 	m_AllocSize = 0;
+	m_Arena = NULL;
+	m_ArenaSize = 0;
+	m_ArenaUsed = 0;
+	m_IndexBuilt = false;
 }
 
 AtomicResult::~AtomicResult()
@@ -389,14 +726,11 @@ AtomicResult::~AtomicResult()
 		FreeHandle();
 	}
 
-	for (size_t i=0; i<=m_AllocSize; i++)
-	{
-		delete m_Table[i];
-	}
-
-	delete [] m_Table;
+	free(m_Cells);
+	free(m_Arena);
 
-	m_Table = NULL;
+	m_Cells = NULL;
+	m_Arena = NULL;
 	m_IsFree = true;
 }
 
@@ -417,20 +751,30 @@ unsigned int AtomicResult::FieldCount()
 
 bool AtomicResult::FieldNameToNum(const char *name, unsigned int *columnId)
 {
-	for (unsigned int i=0; i<m_FieldCount; i++)
+	// built on first use, from the main thread, most results are never asked
+	if (!m_IndexBuilt)
 	{
-		assert(m_Table[i] != NULL);
-		if (strcmp(m_Table[i]->chars(), name) == 0)
+		m_FieldIndex.clear();
+		for (unsigned int i=0; i<m_FieldCount; i++)
 		{
-			if (columnId)
-			{
-				*columnId = i;
-			}
-			return true;
+			// duplicate names resolve to the first column, like a linear search would
+			m_FieldIndex.insert(&m_Arena[m_Cells[i].offset], i);
 		}
+		m_IndexBuilt = true;
 	}
 
-	return false;
+	unsigned int id;
+	if (!m_FieldIndex.retrieve(name, &id))
+	{
+		return false;
+	}
+
+	if (columnId)
+	{
+		*columnId = id;
+	}
+
+	return true;
 }
 
 const char *AtomicResult::FieldNumToName(unsigned int num)
@@ -438,9 +782,7 @@ const char *AtomicResult::FieldNumToName(unsigned int num)
 	if (num >= m_FieldCount)
 		return NULL;
 
-	assert(m_Table[num] != NULL);
-
-	return m_Table[num]->chars();
+	return &m_Arena[m_Cells[num].offset];
 }
 
 double AtomicResult::GetDouble(unsigned int columnId)
@@ -460,9 +802,17 @@ int AtomicResult::GetInt(unsigned int columnId)
 
 const char *AtomicResult::GetRaw(unsigned int columnId, size_t *length)
 {
-	//we don't support this yet...
-	*length = 0;
-	return "";
+	if (columnId >= m_FieldCount)
+	{
+		*length = 0;
+		return "";
+	}
+
+	ResultCell *pCell = &m_Cells[(m_CurRow * m_FieldCount) + columnId];
+
+	*length = pCell->length;
+
+	return &m_Arena[pCell->offset];
 }
 
 const char *AtomicResult::GetStringSafe(unsigned int columnId)
@@ -479,9 +829,7 @@ const char *AtomicResult::GetString(unsigned int columnId)
 
 	size_t idx = (m_CurRow * m_FieldCount) + columnId;
 
-	assert(m_Table[idx] != NULL);
-
-	return m_Table[idx]->chars();
+	return &m_Arena[m_Cells[idx].offset];
 }
 
 IResultRow *AtomicResult::GetRow()
@@ -508,6 +856,14 @@ void AtomicResult::_InternalClear()
 		return;
 
 	m_IsFree = true;
+
+	if (m_ArenaSize > ARENA_KEEP_SIZE)
+	{
+		free(m_Arena);
+		m_Arena = NULL;
+		m_ArenaSize = 0;
+	}
+	m_ArenaUsed = 0;
 }
 
 void AtomicResult::FreeHandle()
@@ -515,6 +871,37 @@ void AtomicResult::FreeHandle()
 	_InternalClear();
 }
 
+void AtomicResult::_StoreCell(ResultCell *pCell, const char *str)
+{
+	if (!str)
+	{
+		str = "";
+	}
+
+	size_t length = strlen(str);
+	size_t needed = m_ArenaUsed + length + 1;
+
+	if (needed > m_ArenaSize)
+	{
+		size_t size = m_ArenaSize ? m_ArenaSize : 4096;
+		while (size < needed)
+		{
+			size *= 2;
+		}
+
+		// cells only keep offsets, moving the arena is fine
+		m_Arena = (char *)realloc(m_Arena, size);
+		m_ArenaSize = size;
+	}
+
+	memcpy(&m_Arena[m_ArenaUsed], str, length + 1);
+
+	pCell->offset = m_ArenaUsed;
+	pCell->length = length;
+
+	m_ArenaUsed = needed;
+}
+
 void AtomicResult::CopyFrom(IResultSet *rs)
 {
 	if (!m_IsFree)
@@ -523,6 +910,8 @@ void AtomicResult::CopyFrom(IResultSet *rs)
 	}
 
 	m_IsFree = false;
+	m_IndexBuilt = false;
+	m_ArenaUsed = 0;
 
 	m_FieldCount = rs->FieldCount();
 	m_RowCount = rs->RowCount();
@@ -531,25 +920,14 @@ void AtomicResult::CopyFrom(IResultSet *rs)
 	size_t newTotal = (m_RowCount * m_FieldCount) + m_FieldCount;
 	if (newTotal > m_AllocSize)
 	{
-		ke::AString **table = new ke::AString *[newTotal];
-		memset(table, 0, newTotal * sizeof(ke::AString *));
-		if (m_Table)
-		{
-			memcpy(table, m_Table, m_AllocSize * sizeof(ke::AString *));
-			delete [] m_Table;
-		}
-		m_Table = table;
+		free(m_Cells);
+		m_Cells = (ResultCell *)malloc(newTotal * sizeof(ResultCell));
 		m_AllocSize = newTotal;
 	}
 
 	for (unsigned int i=0; i<m_FieldCount; i++)
 	{
-		if (m_Table[i])
-		{
-			*m_Table[i] = rs->FieldNumToName(i);
-		} else {
-			m_Table[i] = new ke::AString(rs->FieldNumToName(i));
-		}
+		_StoreCell(&m_Cells[i], rs->FieldNumToName(i));
 	}
 
 	IResultRow *row;
@@ -559,12 +937,7 @@ void AtomicResult::CopyFrom(IResultSet *rs)
 		row = rs->GetRow();
 		for (unsigned int i=0; i<m_FieldCount; i++,idx++)
 		{
-			if (m_Table[idx])
-			{
-				*m_Table[idx] = row->GetString(i);
-			} else {
-				m_Table[idx] = new ke::AString(row->GetString(i));
-			}
+			_StoreCell(&m_Cells[idx], row->GetString(i));
 		}
 		rs->NextRow();
 	}
@@ -583,5 +956,9 @@ bool AtomicResult::NextResultSet()
 AMX_NATIVE_INFO g_ThreadSqlNatives[] =
 {
 	{"SQL_ThreadQuery",			SQL_ThreadQuery},
+	{"SQL_CreateTransaction",	SQL_CreateTransaction},
+	{"SQL_AddQuery",			SQL_AddQuery},
+	{"SQL_ExecuteTransaction",	SQL_ExecuteTransaction},
+	{"SQL_GetTransactionResult",	SQL_GetTransactionResult},
 	{NULL,						NULL},
 };